@@ -4,11 +4,17 @@
 //
 #pragma once
 
+#include <fstream>
+#include <iomanip>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 
 #include "RandomLocalSearcher.hpp"
 #include "BeamSearcher.hpp"
+#include "NetClusterer.hpp"
+#include "NetPartitioner.hpp"
 #include "Visualizer.hpp"
 
 using namespace fbp;
@@ -20,18 +26,94 @@ class AdaptiveSelecter {
 		int value;
 		int iter; // rls：交换次数，bs：束宽度
 		shared_ptr<FloorplanPacker> fbp_solver;
+		double lower_bound; // 该宽度下目标函数的下界
+		Config::LevelFloorplanPacker packer;
+		int visit_num = 0; // 被adaptive_step选中的次数，仅用于收敛轨迹
 	};
 
+	/// 组合模式下一种packer的全部候选宽度及其近期收益
+	struct PackerArm {
+		Config::LevelFloorplanPacker packer;
+		vector<CandidateWidth> cw_objs;
+		double gain = 0; // 衰减累计的相对改进量
+		double cost = 0; // 衰减累计的开销：秒，确定性模式下为步数
+		double total_cost = 0;
+
+		double rate() const { return cost > 0 ? gain / cost : 0; }
+	};
+
+	/// 一个搜索线程的上下文：独立的随机流、候选宽度的选择分布和剩余工作量预算
+	struct SearchContext {
+		default_random_engine gen;
+		discrete_distribution<> discrete_dist;
+		uniform_int_distribution<> uniform_dist;
+		long long step_budget;
+		double next_trace = 0; // 下次输出访问次数的时间(秒)
+
+		SearchContext(unsigned int seed, int width_num, long long step_budget) : gen(seed), step_budget(step_budget) { resize(width_num); }
+
+		/// 候选宽度数目变化时重建选择分布，越后面的候选宽度选中概率越大
+		void resize(int width_num) {
+			vector<int> probs; probs.reserve(width_num);
+			for (int i = 1; i <= width_num; ++i) { probs.push_back(2 * i); }
+			discrete_dist = discrete_distribution<>(probs.begin(), probs.end());
+			uniform_dist = uniform_int_distribution<>(0, width_num - 1);
+		}
+
+		bool has_budget() const { return step_budget > 0; }
+	};
+
+	/// 岛屿间的通信：mailboxes[receiver * island_num + sender]，每个发送方独占一个槽
+	struct IslandChannel {
+		int island_num;
+		vector<utils::Mailbox<vector<int>>> mailboxes;
+		utils::Barrier barrier; // 确定性模式下同步迁移
+
+		IslandChannel(int island_num) : island_num(island_num), mailboxes(island_num * island_num), barrier(island_num) {}
+	};
+
+	/// 随机流编号，各子种子均由`cfg.random_seed`派生
+	enum SeedStream { SelectorStream, RlsStream, BsStream, IslandStream, MultilevelStream, PartitionStream,
+		MultilevelClusterStream, MultilevelTopStream, MultilevelRefineStream };
+
 public:
 
 	AdaptiveSelecter() = delete;
 
-	AdaptiveSelecter(const Environment& env, const Config& cfg) :
-		_env(env), _cfg(cfg), _ins(env), _gen(_cfg.random_seed), _start(clock()), _duration(0), _iteration(0),
+	AdaptiveSelecter(const Environment& env, const Config& cfg) : AdaptiveSelecter(env, cfg, Instance(env)) {}
+
+	/// 求解内存中构造的实例(多层流程的子问题)
+	AdaptiveSelecter(const Environment& env, const Config& cfg, Instance ins) :
+		_env(env), _cfg(cfg), _ins(move(ins)), _deadline(_cfg.ub_time), _duration(0), _iteration(0),
 		_best_area(numeric_limits<int>::max()), _best_wirelength(numeric_limits<double>::max()),
-		_best_objective(numeric_limits<double>::max()), _best_fillratio(0), _best_whratio(0), _dst() {}
+		_best_objective(numeric_limits<double>::max()), _best_fillratio(0), _best_whratio(0), _best_width(0), _dst(), _warm_width(0), _dist_lower_bound(0), _lower_bound(0), _target_duration(-1), _target_iteration(0), _pack_num(0), _prune_num(0), _run_time(0), _peak_rss(0), _next_checkpoint(cfg.checkpoint_interval) {}
 
+	/// 求解；定义FBP_PROFILE时统计本次求解中各阶段的耗时
 	void run() {
+		auto run_start = chrono::steady_clock::now();
+		{
+			utils::Profiler::Attach profile_attach(_profiler);
+			solve();
+		}
+		_run_time = chrono::duration<double>(chrono::steady_clock::now() - run_start).count();
+		_profile = _profiler.total();
+		_ins.account_memory(_memory);
+		_peak_rss = utils::peak_rss_bytes();
+		if (!_cfg.quiet) {
+			fprintf(stdout, "%s: memory %.1f MB accounted, peak RSS %.1f MB.\n", _env._ins_name.c_str(), _memory.total() / 1048576.0, _peak_rss / 1048576.0);
+		}
+	}
+
+	void solve() {
+		if (_cfg.multilevel && _ins.get_block_num() > _cfg.ml_top_size) {
+			search_multilevel();
+			return;
+		}
+		if (_cfg.partition_num > 1 && _ins.get_block_num() > _cfg.partition_num) {
+			search_partitioned();
+			return;
+		}
+
 		vector<Rect> src = _ins.get_rects();
 
 		// Calculate the set of candidate widths W
@@ -52,54 +134,363 @@ public:
 		default: assert(false); break;
 		}
 
-		// 初始化离散概率分布
-		vector<int> probs; probs.reserve(candidate_widths.size());
-		for (int i = 1; i <= candidate_widths.size(); ++i) { probs.push_back(2 * i); }
-		discrete_distribution<> discrete_dist(probs.begin(), probs.end());
-		// 初始化均匀分布
-		uniform_int_distribution<> uniform_dist(0, candidate_widths.size() - 1);
+		if (_cfg.target_ratio > 0 && !obj_map.count(_env._ins_name)) {
+			fprintf(stderr, "%s: no reference in obj_map, target ratio ignored.\n", _env._ins_name.c_str());
+		}
+
+		if (_cfg.fixed_outline) { // 固定边框：宽度不超过边框宽度，且在边框高度内容得下总面积
+			candidate_widths.erase(remove_if(candidate_widths.begin(), candidate_widths.end(), [this](int cw) {
+				return cw > _ins.get_fixed_width() || cw * _ins.get_fixed_height() < _ins.get_total_area(); }), candidate_widths.end());
+			if (candidate_widths.empty()) {
+				if (_cfg.quiet) { return; }
+				fprintf(stderr, "%s: no candidate width fits the %dx%d outline.\n", _env.blocks_path().c_str(), _ins.get_fixed_width(), _ins.get_fixed_height());
+				return;
+			}
+		}
+
+		if (_cfg.eco) {
+			if (!load_eco(candidate_widths)) { return; }
+		}
+		else if (_cfg.warm_start) { load_warm_start(candidate_widths); }
 
+		_dist_lower_bound = cal_dist_lower_bound();
+		_lower_bound = numeric_limits<double>::max();
+		for (int cw : candidate_widths) { _lower_bound = min(_lower_bound, cal_lower_bound(src, cw)); }
+
+		SearchContext ctx(utils::split_seed(_cfg.random_seed, SelectorStream), candidate_widths.size(), total_step_budget());
+		if (_cfg.trace_interval > 0) { start_trace(candidate_widths); }
 		switch (_cfg.level_asa_fbp) {
 		case Config::LevelFloorplanPacker::RandomLocalSearch:
-			search<RandomLocalSearcher>(src, candidate_widths, discrete_dist, uniform_dist);
+			if (_cfg.island_num > 1) { search_islands(src, candidate_widths); }
+			else { search<RandomLocalSearcher>(src, candidate_widths, ctx); }
 			break;
 		case Config::LevelFloorplanPacker::BeamSearch:
-			search<BeamSearcher>(src, candidate_widths, discrete_dist, uniform_dist);
+			search<BeamSearcher>(src, candidate_widths, ctx);
+			break;
+		case Config::LevelFloorplanPacker::Portfolio:
+			search_portfolio(src, candidate_widths, ctx);
 			break;
 		default:
 			assert(false);
 			break;
 		}
+		_checkpoint_writer.reset(); // 等待最后一份检查点写完
+		_trace_writer.reset();
+
+		if (_cfg.quiet) { return; }
+		if (!_dst.empty()) {
+			fprintf(stdout, "%s: lower bound %f, gap %.2f%%.\n", _env._ins_name.c_str(), _lower_bound, 100.0 * (_best_objective / _lower_bound - 1));
+		}
+		if (_cfg.fixed_outline) {
+			fprintf(stdout, "%s: outline %dx%d, %lld/%lld packings feasible (%.2f%%), %s.\n", _env.blocks_path().c_str(),
+				_ins.get_fixed_width(), _ins.get_fixed_height(), _pack_num - _prune_num, _pack_num,
+				_pack_num ? 100.0 * (_pack_num - _prune_num) / _pack_num : 0.0, _dst.empty() ? "infeasible" : "feasible");
+		}
 	}
 
+	/// 取消正在进行的搜索，可从其他线程调用；已运行的求解器在下一步之前被抢占
+	void cancel() { _deadline.cancel(); }
+
+	/// 最优解的每次改进，按时间递增，用于绘制质量-时间曲线
+	struct Improvement {
+		double time;
+		double objective;
+		int area;
+		double wirelength;
+	};
+
+	const vector<Improvement>& get_improvements() const { return _improvements; }
+
+	double get_best_objective() const { return _best_objective; }
+
+	int get_best_area() const { return _best_area; }
+
+	double get_best_wirelength() const { return _best_wirelength; }
+
+	/// 求解结束时的内存分项统计及进程峰值常驻内存(字节)
+	const utils::MemoryUsage& get_memory_usage() const { return _memory; }
+
+	long long get_peak_rss() const { return _peak_rss; }
+
 	template<typename T>
-	void search(vector<Rect>& src, vector<int>& candidate_widths, discrete_distribution<>& discrete_dist, uniform_int_distribution<>& uniform_dist) {
-		// 初始化iter=1
-		vector<CandidateWidth> cw_objs; cw_objs.reserve(candidate_widths.size());
-		for (int bin_width : candidate_widths) {
-			cw_objs.push_back({ bin_width, 1, make_shared<T>(_ins, src, bin_width, _gen) });
-			cw_objs.back().fbp_solver->run(1, _cfg.alpha, _cfg.beta, _cfg.level_fbp_wl, _cfg.level_fbp_dist);
-			update_objective(cw_objs.back());
+	void search(vector<Rect>& src, vector<int>& candidate_widths, SearchContext& ctx) {
+		vector<PackerArm> arms = { { packer_level<T>() } };
+		if ((_cfg.resume && load_checkpoint(src, ctx, arms)) || init_candidate_widths<T>(src, candidate_widths, ctx, arms[0].cw_objs)) {
+			// 迭代优化
+			while (!_deadline.expired() && ctx.has_budget()) {
+				prune_candidate_widths(arms[0].cw_objs, ctx);
+				adaptive_step(arms[0].cw_objs, ctx);
+				checkpoint(ctx, arms);
+				if (is_trace_due(ctx)) { trace_visits(arms[0].cw_objs); }
+			}
 		}
-		// 降序排列，越后面的质量越好选中概率越大
-		sort(cw_objs.begin(), cw_objs.end(), [](auto& lhs, auto& rhs) {
-			return lhs.fbp_solver->get_objective() > rhs.fbp_solver->get_objective(); });
-		// 迭代优化
-		while (static_cast<double>(clock() - _start) / CLOCKS_PER_SEC < _cfg.ub_time) {
-			CandidateWidth& picked_width = _gen() % 10 ? cw_objs[discrete_dist(_gen)] : cw_objs[uniform_dist(_gen)]; // 疏散性：90%概率选择，10%随机选择
-			double old_objective = picked_width.fbp_solver->get_objective();
-			picked_width.iter = min(2 * picked_width.iter, _cfg.ub_iter);
-			picked_width.fbp_solver->run(picked_width.iter, _cfg.alpha, _cfg.beta, _cfg.level_fbp_wl, _cfg.level_fbp_dist);
-			update_objective(picked_width);
-			// 重新排序
-			if (picked_width.fbp_solver->get_objective() < old_objective) {
-				sort(cw_objs.begin(), cw_objs.end(), [](auto& lhs, auto& rhs) {
-					return lhs.fbp_solver->get_objective() > rhs.fbp_solver->get_objective(); });
+		if (_trace_writer) { trace_visits(arms[0].cw_objs); }
+		collect_packer_stats(arms[0].cw_objs);
+	}
+
+	/// 多层流程：自底向上逐层求解各簇(以下一层节点为块的子问题)，顶层在剩余时间内求解，
+	/// 自顶向下展开为块的坐标，再以簇外引脚为terminal在原外框内重新打包底层簇
+	/// 剩余时间在尚未开始的阶段(各层、顶层、细化)之间均分，所有子问题都受本次求解的截止时间约束
+	void search_multilevel() {
+		NetClusterer clusterer(_ins, _cfg.ml_cluster_size, _cfg.ml_top_size, utils::split_seed(_cfg.random_seed, MultilevelStream));
+		const auto& levels = clusterer.get_levels();
+		int top = levels.size() - 1;
+		vector<vector<Rect>> shapes(levels.size()); // shapes[l][v]：第l层节点的外框，第0层为块的原尺寸
+		vector<vector<vector<Rect>>> layouts(levels.size()); // layouts[l][c]：第l层簇c的成员在簇内的局部坐标
+		shapes[0] = _ins.get_rects(false);
+		for (int l = 1; l <= top; ++l) {
+			vector<vector<Net>> cluster_nets = restrict_nets(levels[l - 1].nets, levels[l].members);
+			layouts[l].resize(levels[l].members.size());
+			shapes[l].resize(levels[l].members.size());
+			double cluster_time = subproblem_time(1.0 / (top - l + 3), levels[l].members.size());
+			utils::parallel_for(levels[l].members.size(), [&](int c) {
+				const vector<int>& members = levels[l].members[c];
+				vector<Block> blocks(members.size());
+				for (int i = 0; i < members.size(); ++i) {
+					blocks[i].name = to_string(members[i]);
+					blocks[i].width = shapes[l - 1][members[i]].width;
+					blocks[i].height = shapes[l - 1][members[i]].height;
+				}
+				Config sub_cfg = subproblem_config(utils::split_seed(utils::split_seed(utils::split_seed(_cfg.random_seed, MultilevelClusterStream), l), c));
+				sub_cfg.alpha = 1; // 簇的外框是上一层的块，空白逐层累积，簇内只优化面积；线长由顶层和细化负责
+				sub_cfg.beta = 0;
+				layouts[l][c] = solve_subproblem(Instance(_env, move(blocks), {}, move(cluster_nets[c])), sub_cfg, cluster_time);
+				shapes[l][c] = bounding_box(layouts[l][c]);
+				shapes[l][c].id = c;
+			});
+		}
+
+		// 顶层：全部顶层节点作为块，线网带上原有的terminal
+		vector<int> owner(_ins.get_block_num()); // 块 -> 顶层节点
+		iota(owner.begin(), owner.end(), 0);
+		for (int l = 1; l <= top; ++l) {
+			vector<int> parent(levels[l - 1].areas.size());
+			for (int c = 0; c < levels[l].members.size(); ++c) {
+				for (int v : levels[l].members[c]) { parent[v] = c; }
 			}
+			for (int& v : owner) { v = parent[v]; }
+		}
+		vector<Block> blocks(shapes[top].size());
+		for (int v = 0; v < blocks.size(); ++v) {
+			blocks[v].name = to_string(v);
+			blocks[v].width = shapes[top][v].width;
+			blocks[v].height = shapes[top][v].height;
 		}
+		vector<Terminal> terminals = _ins.get_terminals();
+		for (auto& terminal : terminals) { terminal.net_ids.clear(); }
+		vector<Net> nets;
+		for (auto& net : _ins.get_netlist()) {
+			Net top_net;
+			for (int bid : net.block_list) { top_net.block_list.push_back(owner[bid]); }
+			sort(top_net.block_list.begin(), top_net.block_list.end());
+			top_net.block_list.erase(unique(top_net.block_list.begin(), top_net.block_list.end()), top_net.block_list.end());
+			top_net.terminal_list = net.terminal_list;
+			if (top_net.block_list.size() >= 2 || (!top_net.block_list.empty() && !top_net.terminal_list.empty())) { nets.push_back(move(top_net)); }
+		}
+		Config top_cfg = subproblem_config(utils::split_seed(_cfg.random_seed, MultilevelTopStream));
+		top_cfg.ub_step = _cfg.ub_step;
+		top_cfg.level_asa_cw = _cfg.level_asa_cw;
+		top_cfg.level_fbp_wl = _cfg.level_fbp_wl;
+		top_cfg.fixed_outline = _cfg.fixed_outline;
+		vector<Rect> top_layout = solve_subproblem(Instance(_env, move(blocks), move(terminals), move(nets),
+			_ins.get_fixed_width(), _ins.get_fixed_height()), top_cfg, subproblem_time(0.5, 1));
+
+		vector<Rect> dst = expand_layouts(levels, shapes, layouts, top_layout);
+		int refined_num = refine_clusters(levels, shapes, layouts, dst, top_layout);
+		if (refined_num > 0) { dst = expand_layouts(levels, shapes, layouts, top_layout); }
+
+		set_layout(move(dst));
+		if (_cfg.quiet) { return; }
+		ostringstream sizes;
+		for (int l = 0; l <= top; ++l) { sizes << (l ? "/" : "") << levels[l].areas.size(); }
+		fprintf(stdout, "%s: multilevel %s nodes, %d/%zu clusters refined, fill ratio %.2f%%, %.2fs.\n", _env._ins_name.c_str(),
+			sizes.str().c_str(), refined_num, top > 0 ? levels[1].members.size() : 0, 100 * _best_fillratio, _duration);
+	}
+
+	/// 分区模式：按线网把块递归二分为partition_num份，各份以二分树中区域的宽度为宽度预算并行求解，
+	/// 跨分区的线网以其他块所在区域的中心为terminal；最后沿二分树横向或纵向拼接各份的子布局
+	void search_partitioned() {
+		NetPartitioner partitioner(_ins, _cfg.partition_num, utils::split_seed(_cfg.random_seed, PartitionStream));
+		assert(partitioner.check());
+		const auto& nodes = partitioner.get_nodes();
+		const auto& parts = partitioner.get_parts();
+
+		// 自顶向下划分区域：面积按比例分配，垂直于长边切开
+		vector<array<double, 4>> regions(nodes.size()); // x, y, w, h
+		double side = sqrt(_ins.get_total_area());
+		regions[0] = { 0, 0, side, side };
+		vector<int> is_vertical(nodes.size(), 0);
+		for (int v = 0; v < nodes.size(); ++v) {
+			if (nodes[v].part >= 0) { continue; }
+			auto& r = regions[v];
+			double share = 1.0 * nodes[nodes[v].left].area / nodes[v].area;
+			is_vertical[v] = r[2] >= r[3];
+			if (is_vertical[v]) {
+				regions[nodes[v].left] = { r[0], r[1], r[2] * share, r[3] };
+				regions[nodes[v].right] = { r[0] + r[2] * share, r[1], r[2] * (1 - share), r[3] };
+			}
+			else {
+				regions[nodes[v].left] = { r[0], r[1], r[2], r[3] * share };
+				regions[nodes[v].right] = { r[0], r[1] + r[3] * share, r[2], r[3] * (1 - share) };
+			}
+		}
+		vector<int> leaf_of(parts.size()), part_of(_ins.get_block_num());
+		for (int v = 0; v < nodes.size(); ++v) {
+			if (nodes[v].part >= 0) { leaf_of[nodes[v].part] = v; }
+		}
+		for (int p = 0; p < parts.size(); ++p) {
+			for (int b : parts[p]) { part_of[b] = p; }
+		}
+
+		vector<vector<Rect>> layouts(parts.size());
+		int thread_num = max(1u, thread::hardware_concurrency());
+		double part_time = subproblem_time(1, parts.size(), thread_num);
+		utils::parallel_for(parts.size(), [&](int p) {
+			const auto& region = regions[leaf_of[p]];
+			vector<int> local(_ins.get_block_num(), -1);
+			vector<Block> blocks(parts[p].size());
+			for (int i = 0; i < parts[p].size(); ++i) {
+				const Block& block = _ins.get_blocks().at(parts[p][i]);
+				local[parts[p][i]] = i;
+				blocks[i].name = block.name;
+				blocks[i].width = block.width;
+				blocks[i].height = block.height;
+			}
+			vector<Terminal> terminals;
+			vector<Net> nets;
+			unordered_set<int> net_ids;
+			for (int b : parts[p]) { net_ids.insert(_ins.get_blocks().at(b).net_ids.begin(), _ins.get_blocks().at(b).net_ids.end()); }
+			for (int nid : net_ids) {
+				const Net& net = _ins.get_netlist().at(nid);
+				Net part_net;
+				auto add_terminal = [&](double x, double y) {
+					Terminal terminal;
+					terminal.x_coordinate = static_cast<int>(x - region[0]);
+					terminal.y_coordinate = static_cast<int>(y - region[1]);
+					part_net.terminal_list.push_back(terminals.size());
+					terminals.push_back(terminal);
+				};
+				unordered_set<int> other_parts; // 同一分区的外部块只取一次区域中心
+				for (int b : net.block_list) {
+					if (local[b] >= 0) { part_net.block_list.push_back(local[b]); }
+					else if (other_parts.insert(part_of[b]).second) {
+						const auto& other = regions[leaf_of[part_of[b]]];
+						add_terminal(other[0] + other[2] / 2, other[1] + other[3] / 2);
+					}
+				}
+				if (_cfg.level_fbp_wl == Config::LevelWireLength::BlockAndTerminal) {
+					for (int tid : net.terminal_list) { add_terminal(_ins.get_terminals().at(tid).x_coordinate, _ins.get_terminals().at(tid).y_coordinate); }
+				}
+				if (part_net.block_list.size() + part_net.terminal_list.size() >= 2) { nets.push_back(move(part_net)); }
+			}
+			Instance ins(_env, move(blocks), move(terminals), move(nets));
+			Config sub_cfg = subproblem_config(utils::split_seed(utils::split_seed(_cfg.random_seed, PartitionStream), p));
+			sub_cfg.ub_step = _cfg.ub_step > 0 ? max(1LL, _cfg.ub_step / static_cast<long long>(parts.size())) : 0;
+			sub_cfg.level_fbp_wl = Config::LevelWireLength::BlockAndTerminal;
+			double root_area = sqrt(ins.get_total_area()); // 宽度预算：候选宽度取区域宽度附近
+			sub_cfg.lb_scale = 0.9 * region[2] / root_area;
+			sub_cfg.ub_scale = 1.1 * region[2] / root_area;
+			layouts[p] = solve_subproblem(move(ins), sub_cfg, part_time);
+		}, thread_num);
+
+		// 自底向上拼接：左(下)子布局在原点，右(上)子布局紧挨其右侧(上方)
+		vector<Rect> boxes(nodes.size());
+		vector<pair<int, int>> offsets(nodes.size()); // 相对父节点的偏移
+		for (int v = nodes.size() - 1; v >= 0; --v) { // 子节点编号总大于父节点
+			if (nodes[v].part >= 0) {
+				boxes[v] = bounding_box(layouts[nodes[v].part]);
+				continue;
+			}
+			const Rect& l = boxes[nodes[v].left];
+			const Rect& r = boxes[nodes[v].right];
+			offsets[nodes[v].left] = { 0, 0 };
+			if (is_vertical[v]) {
+				offsets[nodes[v].right] = { l.width, 0 };
+				boxes[v] = { v, 0, 0, l.width + r.width, max(l.height, r.height) };
+			}
+			else {
+				offsets[nodes[v].right] = { 0, l.height };
+				boxes[v] = { v, 0, 0, max(l.width, r.width), l.height + r.height };
+			}
+		}
+		for (int v = 0; v < nodes.size(); ++v) { // 偏移累加为绝对坐标
+			if (nodes[v].left < 0) { continue; }
+			for (int child : { nodes[v].left, nodes[v].right }) {
+				offsets[child].first += offsets[v].first;
+				offsets[child].second += offsets[v].second;
+			}
+		}
+		vector<Rect> dst(_ins.get_block_num());
+		for (int p = 0; p < parts.size(); ++p) {
+			for (int i = 0; i < parts[p].size(); ++i) {
+				Rect rect = layouts[p][i];
+				rect.id = parts[p][i];
+				rect.x += offsets[leaf_of[p]].first;
+				rect.y += offsets[leaf_of[p]].second;
+				dst[rect.id] = rect;
+			}
+		}
+		set_layout(move(dst));
+		if (_cfg.quiet) { return; }
+		fprintf(stdout, "%s: %zu partitions, %d/%d nets cut, fill ratio %.2f%%, %.2fs.\n", _env._ins_name.c_str(),
+			parts.size(), partitioner.cal_cut_num(), _ins.get_net_num(), 100 * _best_fillratio, _duration);
+	}
+
+	/// 组合模式：每个候选宽度同时保留RLS和BS，交替运行，按近期单位开销的相对改进量分配算力
+	void search_portfolio(vector<Rect>& src, vector<int>& candidate_widths, SearchContext& ctx) {
+		static constexpr double decay = 0.9; // 衰减旧的统计量，使分配能跟随搜索阶段变化
+		vector<PackerArm> arms = { { Config::LevelFloorplanPacker::RandomLocalSearch }, { Config::LevelFloorplanPacker::BeamSearch } };
+		bool is_ready = (_cfg.resume && load_checkpoint(src, ctx, arms))
+			|| (init_candidate_widths<RandomLocalSearcher>(src, candidate_widths, ctx, arms[0].cw_objs)
+				&& init_candidate_widths<BeamSearcher>(src, candidate_widths, ctx, arms[1].cw_objs));
+		while (is_ready && !_deadline.expired() && ctx.has_budget()) {
+			for (auto& arm : arms) { prune_candidate_widths(arm.cw_objs, ctx); }
+			// 目标份额：10%均分保证疏散性，90%按单位开销改进量分配；选择实际开销落后份额最多的packer
+			double total_rate = arms[0].rate() + arms[1].rate();
+			double total_cost = arms[0].total_cost + arms[1].total_cost;
+			int k = 0;
+			double max_deficit = numeric_limits<double>::lowest();
+			for (int i = 0; i < 2; ++i) {
+				double share = 0.05 + 0.9 * (total_rate > 0 ? arms[i].rate() / total_rate : 0.5);
+				double deficit = share * total_cost - arms[i].total_cost;
+				if (deficit > max_deficit) { max_deficit = deficit; k = i; }
+			}
+			PackerArm& arm = arms[k];
+			double old_objective = arm.cw_objs.back().fbp_solver->get_objective();
+			double start = _deadline.elapsed();
+			long long steps = adaptive_step(arm.cw_objs, ctx);
+			double cost = is_deterministic() ? steps : _deadline.elapsed() - start; // 确定性模式下不依赖计时
+			arm.gain = decay * arm.gain + (old_objective - arm.cw_objs.back().fbp_solver->get_objective()) / old_objective;
+			arm.cost = decay * arm.cost + cost;
+			arm.total_cost += cost;
+			checkpoint(ctx, arms);
+			if (is_trace_due(ctx)) {
+				for (auto& arm : arms) { trace_visits(arm.cw_objs); }
+			}
+		}
+		for (auto& arm : arms) {
+			if (_trace_writer) { trace_visits(arm.cw_objs); }
+			collect_packer_stats(arm.cw_objs);
+			if (arm.cw_objs.empty() || _cfg.quiet) { continue; }
+			fprintf(stdout, "%s: cost %.2f, objective %f\n", packer_name(arm.packer), arm.total_cost, arm.cw_objs.back().fbp_solver->get_objective());
+		}
+	}
+
+	/// 岛屿模型：候选宽度连续切分给各岛屿，各岛屿并行运行ASA+RLS，定期向邻居迁移精英序列
+	void search_islands(vector<Rect>& src, vector<int>& candidate_widths) {
+		IslandChannel channel(min<int>(_cfg.island_num, candidate_widths.size()));
+		vector<thread> islands; islands.reserve(channel.island_num);
+		for (int i = 0; i < channel.island_num; ++i) {
+			vector<int> island_widths(
+				candidate_widths.begin() + candidate_widths.size() * i / channel.island_num,
+				candidate_widths.begin() + candidate_widths.size() * (i + 1) / channel.island_num);
+			islands.emplace_back(&AdaptiveSelecter::search_island, this, i, cref(src), move(island_widths), ref(channel));
+		}
+		for (auto& island : islands) { island.join(); }
 	}
 
 	void record_fp(const string& fp_path) const {
+		lock_guard<mutex> guard(utils::path_mutex(fp_path));
 		ofstream fp_file(fp_path);
 		for (auto& r : _dst) {
 			fp_file << _ins.get_blocks().at(r.id).name << " " << r.x << " " << r.y << endl;
@@ -110,7 +501,26 @@ public:
 		}
 	}
 
+	/// 输出非支配解集，按面积升序；任意α/β下的最优解即α·Area+β·Dist最小的一行
+	void record_pareto(const string& pareto_path) const {
+		vector<ParetoArchive::Entry> entries = _archive.get_entries();
+		lock_guard<mutex> guard(utils::path_mutex(pareto_path));
+		ofstream pareto_file(pareto_path);
+		pareto_file << "Area,Dist,WireLength,Width,FillRatio" << endl;
+		for (auto& entry : entries) {
+			pareto_file << entry.area << "," << entry.dist << "," << entry.wirelength << "," << entry.bin_width << ","
+				<< 1.0 * _ins.get_total_area() / entry.area << endl;
+		}
+		fprintf(stdout, "%s: %zu non-dominated (area, dist) points.\n", pareto_path.c_str(), entries.size());
+		ParetoArchive::Entry best;
+		if (_archive.get_best(_cfg.alpha, _cfg.beta, best)) { // 与搜索结果对照，二者应一致
+			fprintf(stdout, "%s: archive optimum %f at alpha=%g beta=%g, search best %f.\n", pareto_path.c_str(),
+				_cfg.alpha * best.area + _cfg.beta * best.dist, _cfg.alpha, _cfg.beta, _best_objective);
+		}
+	}
+
 	void draw_fp(string html_path, bool draw_wire = false) const {
+		lock_guard<mutex> guard(utils::path_mutex(html_path));
 		visualizer::Drawer html_drawer(html_path, _ins.get_fixed_width() * 2, _ins.get_fixed_height() * 2);
 		for (auto& r : _dst) { html_drawer.rect(r.x, r.y, r.width, r.height); }
 		for (auto& t : _ins.get_terminals()) { html_drawer.circle(t.x_coordinate, t.y_coordinate); }
@@ -132,6 +542,7 @@ public:
 	}
 
 	void draw_ins() const {
+		lock_guard<mutex> guard(utils::path_mutex(_env.pl_html_path()));
 		ifstream ifs(_env.pl_html_path());
 		if (ifs.good()) { return; }
 		visualizer::Drawer html_drawer(_env.pl_html_path(), _ins.get_fixed_width(), _ins.get_fixed_height());
@@ -139,7 +550,17 @@ public:
 		for (auto& t : _ins.get_terminals()) { html_drawer.circle(t.x_coordinate, t.y_coordinate); }
 	}
 
+	/// 批量模式下多个任务追加同一个日志文件，整行写入并按路径加锁
 	void record_log() const {
+		ostringstream log_row;
+		log_row << _env._ins_name << ","
+			<< _cfg.alpha << "," << _best_area << "," << _best_fillratio << "," << _best_whratio << ","
+			<< _cfg.beta << "," << _best_wirelength << "," << _best_objective << "," << check_dst() << ","
+			<< _duration << "," << _iteration << "," << _cfg.random_seed << "," << _cfg << "," << seed_tree() << ",";
+		if (_target_duration >= 0) { log_row << _target_duration << "," << _target_iteration; }
+		else { log_row << ","; } // 未设目标或未达到
+		log_row << endl;
+		lock_guard<mutex> guard(utils::path_mutex(_env.log_path()));
 		ofstream log_file(_env.log_path(), ios::app);
 		log_file.seekp(0, ios::end);
 		if (log_file.tellp() <= 0) {
@@ -147,69 +568,850 @@ public:
 				"Alpha,Area,FillRatio,WHRatio,"
 				"Beta,WireLength,Objective,CheckObj,"
 				"Duration,Iteration,RandomSeed,"
-				"LevelFloorplanPacker,LevelWireLength,LevelObjDist" << endl;
+				"LevelFloorplanPacker,LevelWireLength,LevelObjDist,SeedTree,TimeToTarget,TargetIteration" << endl;
 		}
-		log_file << _env._ins_name << ","
-			<< _cfg.alpha << "," << _best_area << "," << _best_fillratio << "," << _best_whratio << ","
-			<< _cfg.beta << "," << _best_wirelength << "," << _best_objective << "," << check_dst() << ","
-			<< _duration << "," << _iteration << "," << _cfg.random_seed << "," << _cfg << endl;
+		log_file << log_row.str();
+		if (utils::Profiler::enabled) { record_profile(); }
+		record_memory();
+	}
+
+	void record_memory() const {
+		ostringstream rows;
+		for (auto& item : _memory.resident) { rows << _env._ins_name << "," << _cfg.random_seed << "," << item.first << ",resident," << item.second << endl; }
+		for (auto& item : _memory.transient) { rows << _env._ins_name << "," << _cfg.random_seed << "," << item.first << ",transient," << item.second << endl; }
+		rows << _env._ins_name << "," << _cfg.random_seed << ",total,," << _memory.total() << endl;
+		rows << _env._ins_name << "," << _cfg.random_seed << ",peak_rss,," << _peak_rss << endl;
+		lock_guard<mutex> guard(utils::path_mutex(_env.memory_path()));
+		ofstream memory_file(_env.memory_path(), ios::app);
+		memory_file.seekp(0, ios::end);
+		if (memory_file.tellp() <= 0) { memory_file << "Instance,RandomSeed,Item,Kind,Bytes" << endl; }
+		memory_file << rows.str();
+	}
+
+	/// 各阶段的调用次数及包含时间，占比相对本次求解的墙钟时间；岛屿模型和子问题多线程累加，占比可超过100%；只计次数的阶段耗时为0
+	void record_profile() const {
+		ostringstream rows;
+		for (int p = 0; p < utils::Profiler::PhaseNum; ++p) {
+			double seconds = _profile[p].nanoseconds * 1e-9;
+			rows << _env._ins_name << "," << _cfg.random_seed << "," << _run_time << "," << utils::Profiler::phase_name(p) << ","
+				<< _profile[p].calls << "," << seconds << "," << (_run_time > 0 ? seconds / _run_time : 0) << ","
+				<< (_profile[p].calls ? 1.0 * _profile[p].nanoseconds / _profile[p].calls : 0) << endl;
+		}
+		lock_guard<mutex> guard(utils::path_mutex(_env.profile_path()));
+		ofstream profile_file(_env.profile_path(), ios::app);
+		profile_file.seekp(0, ios::end);
+		if (profile_file.tellp() <= 0) { profile_file << "Instance,RandomSeed,RunTime,Phase,Calls,Seconds,Share,NsPerCall" << endl; }
+		profile_file << rows.str();
 	}
 
 private:
 	/// 基于排列组合生成候选宽度组合，考虑所有组合及旋转有`2c_n1 + 2²c_n2 + 2³c_n3 + ...`中情况
 	/// 不需要从k=1开始计算组合数，通过[miniterms, maxiterms]参数控制；论文设置maxiterms=3,4,6
+	/// 子集和动态规划：reach[k][mask]记录恰好k项可达的边长和，mask第0位表示含短边、第1位表示含长边，
+	/// 与枚举一致只保留同时含有旋转和未旋转矩形的组合(mask=3)
 	vector<int> cal_candidate_widths_on_combrotate(const vector<Rect>& src, int miniterms = 3, int maxiterms = 6, double alpha = 1.05) {
 		int min_cw = max_element(src.begin(), src.end(), [](auto& lhs, auto& rhs) { return lhs.height < rhs.height; })->height;
 		int max_cw = floor(sqrt(_ins.get_total_area()) * alpha);
-		unordered_set<int> candidate_widths;
-		vector<int> rects(src.size());
-		iota(rects.begin(), rects.end(), 0);
-		for (int k = miniterms; k <= maxiterms; ++k) {
-			utils::Combination kth_comb_rects(rects, k);
-			vector<int> comb_rects, ncomb_rects;
-			while (kth_comb_rects.next_combination(comb_rects, ncomb_rects)) {
-				for (int kk = 1; kk <= comb_rects.size() / 2; ++kk) { // 组合数性质计算一半即可.
-					utils::Combination kth_rotated_rects(comb_rects, kk);
-					vector<int> rotated_rects, nrotated_rects;
-					while (kth_rotated_rects.next_combination(rotated_rects, nrotated_rects)) {
-						int rcw = 0, nrcw = 0;
-						for (int r : rotated_rects) { rcw += src.at(r).height; }
-						for (int nr : nrotated_rects) { rcw += src.at(nr).width; }
-						if (rcw >= min_cw && rcw <= max_cw && rcw * _ins.get_fixed_height() > _ins.get_total_area()) {
-							candidate_widths.insert(rcw);
-						}
-						for (int nr : rotated_rects) { nrcw += src.at(nr).width; }
-						for (int r : nrotated_rects) { nrcw += src.at(r).height; }
-						if (nrcw >= min_cw && nrcw <= max_cw && nrcw * _ins.get_fixed_height() > _ins.get_total_area()) {
-							candidate_widths.insert(nrcw);
-						}
-					}
+		vector<vector<utils::Bitset>> reach(maxiterms + 1, vector<utils::Bitset>(4, utils::Bitset(max_cw + 1)));
+		reach[0][0].set(0);
+		for (auto& rect : src) {
+			for (int k = maxiterms; k >= 1; --k) {
+				for (int mask = 0; mask < 4; ++mask) {
+					reach[k][mask | 1].or_shifted(reach[k - 1][mask], rect.width);
+					reach[k][mask | 2].or_shifted(reach[k - 1][mask], rect.height);
 				}
 			}
 		}
-		return vector<int>(candidate_widths.begin(), candidate_widths.end());
+		vector<int> candidate_widths;
+		for (int cw = min_cw; cw <= max_cw; ++cw) {
+			if (cw * _ins.get_fixed_height() <= _ins.get_total_area()) { continue; }
+			for (int k = miniterms; k <= maxiterms; ++k) {
+				if (reach[k][3].test(cw)) { candidate_widths.push_back(cw); break; }
+			}
+		}
+		return candidate_widths;
 	}
 
 	/// 基于排列组合生成候选宽度组合，仅考虑短边的组合
 	/// 不需要从k=1开始计算组合数，通过[miniterms, maxiterms]参数控制；论文设置maxiterms=3,4,6
+	/// 子集和动态规划：reach[k]记录恰好k项短边可达的和，补集的和为total_width减去子集和
 	vector<int> cal_candidate_widths_on_combshort(const vector<Rect>& src, int miniterms = 3, int maxiterms = 6, double alpha = 1.05) {
 		int min_cw = max_element(src.begin(), src.end(), [](auto& lhs, auto& rhs) { return lhs.height < rhs.height; })->height;
 		int max_cw = floor(sqrt(_ins.get_total_area()) * alpha);
-		unordered_set<int> candidate_widths;
-		vector<int> rects(src.size());
-		iota(rects.begin(), rects.end(), 0);
-		for (int k = miniterms; k <= maxiterms; ++k) {
-			utils::Combination kth_comb_rects(rects, k);
-			vector<int> comb_rects, ncomb_rects;
-			while (kth_comb_rects.next_combination(comb_rects, ncomb_rects)) {
-				int cw = 0, ncw = 0;
-				for (int r : comb_rects) { cw += src.at(r).width; }
-				if (cw >= min_cw && cw <= max_cw && cw * _ins.get_fixed_height() > _ins.get_total_area()) { candidate_widths.insert(cw); }
-				for (int nr : ncomb_rects) { ncw += src.at(nr).width; }
-				if (ncw >= min_cw && ncw <= max_cw && _ins.get_fixed_height() > _ins.get_total_area()) { candidate_widths.insert(ncw); }
+		int total_width = accumulate(src.begin(), src.end(), 0, [](int sum, auto& rect) { return sum + rect.width; });
+		vector<utils::Bitset> reach(maxiterms + 1, utils::Bitset(total_width + 1));
+		reach[0].set(0);
+		for (auto& rect : src) {
+			for (int k = maxiterms; k >= 1; --k) { reach[k].or_shifted(reach[k - 1], rect.width); }
+		}
+		vector<int> candidate_widths;
+		for (int cw = min_cw; cw <= max_cw && cw <= total_width; ++cw) {
+			if (cw * _ins.get_fixed_height() <= _ins.get_total_area()) { continue; }
+			for (int k = miniterms; k <= maxiterms; ++k) {
+				// 子集本身(k项) or 补集(n-k项)
+				if (reach[k].test(cw) || reach[k].test(total_width - cw)) { candidate_widths.push_back(cw); break; }
+			}
+		}
+		return candidate_widths;
+	}
+
+	/// 初始化iter=1，降序排列，越后面的质量越好选中概率越大；初始化阶段即已超时返回false
+	/// 每个候选宽度的packer使用由(packer类型, 宽度)派生的随机流，与线程划分无关
+	template<typename T>
+	bool init_candidate_widths(const vector<Rect>& src, const vector<int>& candidate_widths, SearchContext& ctx, vector<CandidateWidth>& cw_objs) {
+		cw_objs.reserve(candidate_widths.size());
+		vector<int> init_widths(candidate_widths);
+		stable_partition(init_widths.begin(), init_widths.end(), [this](int cw) { return cw == _warm_width; }); // 热启动宽度最先初始化，即使随后超时也不丢失载入的解
+		for (int bin_width : init_widths) {
+			cw_objs.push_back({ bin_width, 1, make_packer(packer_level<T>(), src, bin_width), cal_lower_bound(src, bin_width), packer_level<T>() });
+			cw_objs.back().fbp_solver->set_bin_height(height_bound(bin_width));
+			cw_objs.back().fbp_solver->set_deadline(&_deadline);
+			cw_objs.back().fbp_solver->set_step_budget(ctx.step_budget);
+			if (bin_width == _warm_width) { // 热启动：载入的解作为该宽度的当前最优解
+				cw_objs.back().fbp_solver->warm_start(_warm_dst, _cfg.alpha, _cfg.beta, _cfg.level_fbp_wl, _cfg.level_fbp_dist);
+			}
+			bool is_done = cw_objs.back().fbp_solver->run(1, _cfg.alpha, _cfg.beta, _cfg.level_fbp_wl, _cfg.level_fbp_dist);
+			ctx.step_budget = cw_objs.back().fbp_solver->get_step_budget();
+			if (is_done && bin_width == _warm_width) { // 其序列作为RLS的排序规则或BS的种子路径
+				cw_objs.back().fbp_solver->accept_sequence(_warm_sequence, _cfg.alpha, _cfg.beta, _cfg.level_fbp_wl, _cfg.level_fbp_dist);
+			}
+			update_objective(cw_objs.back());
+			if (!is_done) { return false; }
+		}
+		sort(cw_objs.begin(), cw_objs.end(), [](auto& lhs, auto& rhs) {
+			return lhs.fbp_solver->get_objective() > rhs.fbp_solver->get_objective(); });
+		return true;
+	}
+
+	template<typename T>
+	static Config::LevelFloorplanPacker packer_level() {
+		return is_same<T, BeamSearcher>::value ? Config::LevelFloorplanPacker::BeamSearch : Config::LevelFloorplanPacker::RandomLocalSearch;
+	}
+
+	shared_ptr<FloorplanPacker> make_packer(Config::LevelFloorplanPacker packer, const vector<Rect>& src, int bin_width) {
+		shared_ptr<FloorplanPacker> fbp_solver;
+		if (packer == Config::LevelFloorplanPacker::BeamSearch) {
+			fbp_solver = make_shared<BeamSearcher>(_ins, src, bin_width, utils::split_seed(utils::split_seed(_cfg.random_seed, BsStream), bin_width));
+		}
+		else {
+			fbp_solver = make_shared<RandomLocalSearcher>(_ins, src, bin_width, utils::split_seed(utils::split_seed(_cfg.random_seed, RlsStream), bin_width));
+		}
+		if (_cfg.pareto_archive) { fbp_solver->set_archive(&_archive); }
+		if (!_eco_fixed.empty()) { fbp_solver->set_fixed(_eco_dst, _eco_fixed); }
+		return fbp_solver;
+	}
+
+	/// 挑选一个候选宽度，加倍iter后继续优化，返回消耗的步数
+	long long adaptive_step(vector<CandidateWidth>& cw_objs, SearchContext& ctx) {
+		CandidateWidth& picked_width = ctx.gen() % 10 ? cw_objs[ctx.discrete_dist(ctx.gen)] : cw_objs[ctx.uniform_dist(ctx.gen)]; // 疏散性：90%概率选择，10%随机选择
+		double old_objective = picked_width.fbp_solver->get_objective();
+		long long old_step_budget = ctx.step_budget;
+		++picked_width.visit_num;
+		picked_width.iter = min(2 * picked_width.iter, _cfg.ub_iter);
+		picked_width.fbp_solver->set_bin_height(height_bound(picked_width.value)); // 随最优解收紧
+		picked_width.fbp_solver->set_step_budget(ctx.step_budget);
+		picked_width.fbp_solver->run(picked_width.iter, _cfg.alpha, _cfg.beta, _cfg.level_fbp_wl, _cfg.level_fbp_dist);
+		ctx.step_budget = picked_width.fbp_solver->get_step_budget();
+		update_objective(picked_width);
+		// 重新排序
+		if (picked_width.fbp_solver->get_objective() < old_objective) {
+			if (_trace_writer) { trace_improvement("improve", picked_width); }
+			sort(cw_objs.begin(), cw_objs.end(), [](auto& lhs, auto& rhs) {
+				return lhs.fbp_solver->get_objective() > rhs.fbp_solver->get_objective(); });
+		}
+		return old_step_budget - ctx.step_budget;
+	}
+
+	/// 单个岛屿，拥有独立的随机流、候选宽度区间和均分的工作量预算
+	void search_island(int island_id, const vector<Rect>& src, vector<int> island_widths, IslandChannel& channel) {
+		utils::Profiler::Attach profile_attach(_profiler);
+		SearchContext ctx(utils::split_seed(utils::split_seed(_cfg.random_seed, IslandStream), island_id),
+			island_widths.size(), total_step_budget() / channel.island_num);
+		vector<CandidateWidth> cw_objs;
+		if (init_candidate_widths<RandomLocalSearcher>(src, island_widths, ctx, cw_objs)) {
+			for (int round = 1; !_deadline.expired() && ctx.has_budget(); ++round) {
+				prune_candidate_widths(cw_objs, ctx);
+				adaptive_step(cw_objs, ctx);
+				if (_cfg.migration_interval > 0 && round % _cfg.migration_interval == 0) { migrate(island_id, cw_objs, channel); }
+				if (is_trace_due(ctx)) { trace_visits(cw_objs, island_id); }
+			}
+		}
+		if (_trace_writer) { trace_visits(cw_objs, island_id); }
+		channel.barrier.arrive_and_drop();
+		collect_packer_stats(cw_objs);
+	}
+
+	/// 迁移：将本岛最优宽度的精英序列发送给邻居，并把收到的序列注入本岛最优宽度
+	/// 确定性模式下所有岛屿投递完毕后再取信、取信完毕后再继续，使迁移结果与线程调度无关
+	void migrate(int island_id, vector<CandidateWidth>& cw_objs, IslandChannel& channel) {
+		auto& best_solver = static_cast<RandomLocalSearcher&>(*cw_objs.back().fbp_solver);
+		int island_num = channel.island_num;
+		for (int i = 0; i < island_num; ++i) {
+			if (i == island_id) { continue; }
+			if (_cfg.level_asa_topology == Config::LevelIslandTopology::Complete
+				|| i == (island_id + 1) % island_num || i == (island_id + island_num - 1) % island_num) {
+				channel.mailboxes[i * island_num + island_id].post(make_unique<vector<int>>(best_solver.get_elite_sequence()));
+			}
+		}
+		if (is_deterministic()) { channel.barrier.arrive_and_wait(); }
+		for (int i = 0; i < island_num; ++i) {
+			unique_ptr<vector<int>> immigrant = channel.mailboxes[island_id * island_num + i].fetch();
+			if (immigrant && best_solver.accept_sequence(*immigrant, _cfg.alpha, _cfg.beta, _cfg.level_fbp_wl, _cfg.level_fbp_dist)) {
+				update_objective(cw_objs.back());
+			}
+		}
+		if (is_deterministic()) { channel.barrier.arrive_and_wait(); }
+	}
+
+	/// 子问题的参数：单线程、按步数终止、不输出报告，候选宽度取平方根附近
+	Config subproblem_config(unsigned int seed) const {
+		Config sub_cfg = _cfg;
+		sub_cfg.random_seed = seed;
+		sub_cfg.multilevel = false;
+		sub_cfg.partition_num = 1;
+		sub_cfg.quiet = true;
+		sub_cfg.ub_step = _cfg.ml_cluster_step;
+		sub_cfg.island_num = 1;
+		sub_cfg.level_asa_cw = Config::LevelCandidateWidth::Sqrt;
+		sub_cfg.level_fbp_wl = Config::LevelWireLength::Block;
+		sub_cfg.warm_start = sub_cfg.eco = sub_cfg.resume = sub_cfg.pareto_archive = sub_cfg.fixed_outline = false;
+		sub_cfg.checkpoint_interval = sub_cfg.trace_interval = 0;
+		sub_cfg.target_objective = sub_cfg.target_ratio = 0;
+		return sub_cfg;
+	}
+
+	/// 剩余时间的`share`由`task_num`个并行的子问题分享：线程数少于任务数时分轮求解，每个子问题得到一轮的时间
+	double subproblem_time(double share, int task_num, int thread_num = max(1u, thread::hardware_concurrency())) const {
+		int rounds = (task_num + thread_num - 1) / thread_num;
+		return _deadline.remaining() * share / max(1, rounds);
+	}
+
+	/// 求解子问题，返回各块的局部坐标；无解时退化为一行排开
+	/// 子问题最多运行`time_limit`秒，并受本次求解的截止时间约束：超时、达到目标或被取消时一并停止
+	vector<Rect> solve_subproblem(Instance ins, const Config& sub_cfg, double time_limit) {
+		AdaptiveSelecter asa(_env, sub_cfg, move(ins));
+		asa._deadline.reset(time_limit);
+		asa._deadline.set_parent(&_deadline);
+		asa.run();
+		_profiler.merge(asa._profile);
+		{
+			lock_guard<mutex> guard(_best_mutex);
+			_memory.merge_transient(asa._memory, "subproblem.");
+		}
+		if (!asa._dst.empty()) { return asa._dst; }
+		vector<Rect> dst = asa._ins.get_rects(false);
+		for (int i = 1; i < dst.size(); ++i) { dst[i].x = dst[i - 1].x + dst[i - 1].width; }
+		for (auto& rect : dst) { rect.y = 0; }
+		return dst;
+	}
+
+	/// 把下一层线网限制到各簇内部，成员按簇内下标编号，只保留连接簇内至少两个成员的部分
+	static vector<vector<Net>> restrict_nets(const vector<vector<int>>& fine_nets, const vector<vector<int>>& members) {
+		vector<int> parent, local;
+		for (int c = 0; c < members.size(); ++c) {
+			for (int i = 0; i < members[c].size(); ++i) {
+				int v = members[c][i];
+				if (v >= parent.size()) { parent.resize(v + 1); local.resize(v + 1); }
+				parent[v] = c;
+				local[v] = i;
+			}
+		}
+		vector<vector<Net>> cluster_nets(members.size());
+		vector<pair<int, int>> pins;
+		for (auto& net : fine_nets) {
+			pins.clear();
+			for (int v : net) { pins.emplace_back(parent[v], local[v]); }
+			sort(pins.begin(), pins.end());
+			for (int i = 0, j; i < pins.size(); i = j) {
+				for (j = i; j < pins.size() && pins[j].first == pins[i].first; ++j) {}
+				if (j - i < 2) { continue; }
+				Net cluster_net;
+				for (int k = i; k < j; ++k) { cluster_net.block_list.push_back(pins[k].second); }
+				cluster_nets[pins[i].first].push_back(move(cluster_net));
+			}
+		}
+		return cluster_nets;
+	}
+
+	/// 自顶向下展开：成员的局部坐标按所在簇的位置平移；簇相对其外框转置放置时，成员坐标与宽高一并转置
+	static vector<Rect> expand_layouts(const vector<NetClusterer::Level>& levels, const vector<vector<Rect>>& shapes,
+		const vector<vector<vector<Rect>>>& layouts, const vector<Rect>& top_layout) {
+		int top = levels.size() - 1;
+		vector<Rect> placed = top_layout;
+		vector<bool> is_transposed(placed.size());
+		for (int v = 0; v < placed.size(); ++v) { is_transposed[v] = is_rotated(placed[v], shapes[top][v]); }
+		for (int l = top; l >= 1; --l) {
+			vector<Rect> fine_placed(shapes[l - 1].size());
+			vector<bool> fine_transposed(shapes[l - 1].size());
+			for (int c = 0; c < levels[l].members.size(); ++c) {
+				for (int i = 0; i < levels[l].members[c].size(); ++i) {
+					int v = levels[l].members[c][i];
+					const Rect& r = layouts[l][c][i];
+					bool is_rotated_in_cluster = is_rotated(r, shapes[l - 1][v]);
+					fine_placed[v] = is_transposed[c] ?
+						Rect{ v, placed[c].x + r.y, placed[c].y + r.x, r.height, r.width } :
+						Rect{ v, placed[c].x + r.x, placed[c].y + r.y, r.width, r.height };
+					fine_transposed[v] = is_transposed[c] != is_rotated_in_cluster;
+				}
+			}
+			placed.swap(fine_placed);
+			is_transposed.swap(fine_transposed);
+		}
+		for (int v = 0; v < placed.size(); ++v) { placed[v].id = v; }
+		return placed;
+	}
+
+	/// 细化：底层簇以簇外引脚(其他块的中心及terminal)为terminal，在原外框内重新打包，线长变短则采用
+	int refine_clusters(const vector<NetClusterer::Level>& levels, const vector<vector<Rect>>& shapes,
+		vector<vector<vector<Rect>>>& layouts, const vector<Rect>& dst, const vector<Rect>& top_layout) {
+		if (levels.size() < 2) { return 0; }
+		const auto& members = levels[1].members;
+		vector<int> parent(_ins.get_block_num()), local(_ins.get_block_num());
+		for (int c = 0; c < members.size(); ++c) {
+			for (int i = 0; i < members[c].size(); ++i) {
+				parent[members[c][i]] = c;
+				local[members[c][i]] = i;
+			}
+		}
+		// 各底层簇在全局中的位置及是否转置，由上层展开得到
+		vector<vector<vector<Rect>>> upper_layouts(layouts.begin(), layouts.end());
+		vector<NetClusterer::Level> upper_levels(levels.begin() + 1, levels.end());
+		vector<vector<Rect>> upper_shapes(shapes.begin() + 1, shapes.end());
+		upper_layouts.erase(upper_layouts.begin());
+		vector<Rect> cluster_placed = expand_layouts(upper_levels, upper_shapes, upper_layouts, top_layout);
+
+		atomic<int> refined_num(0);
+		double refine_time = subproblem_time(1, members.size());
+		utils::parallel_for(members.size(), [&](int c) {
+			const Rect& box = cluster_placed[c];
+			bool is_transposed = is_rotated(box, shapes[1][c]);
+			auto to_local = [&](double x, double y) { // 全局坐标 -> 簇的局部坐标
+				x -= box.x; y -= box.y;
+				if (is_transposed) { swap(x, y); }
+				return make_pair(static_cast<int>(x), static_cast<int>(y));
+			};
+			vector<Block> blocks(members[c].size());
+			for (int i = 0; i < blocks.size(); ++i) {
+				blocks[i].name = _ins.get_blocks().at(members[c][i]).name;
+				blocks[i].width = shapes[0][members[c][i]].width;
+				blocks[i].height = shapes[0][members[c][i]].height;
+			}
+			vector<Terminal> terminals;
+			vector<Net> nets;
+			unordered_set<int> net_ids;
+			for (int bid : members[c]) { net_ids.insert(_ins.get_blocks().at(bid).net_ids.begin(), _ins.get_blocks().at(bid).net_ids.end()); }
+			for (int nid : net_ids) {
+				const Net& net = _ins.get_netlist().at(nid);
+				Net cluster_net;
+				auto add_terminal = [&](double x, double y) {
+					auto xy = to_local(x, y);
+					Terminal terminal;
+					terminal.x_coordinate = xy.first;
+					terminal.y_coordinate = xy.second;
+					cluster_net.terminal_list.push_back(terminals.size());
+					terminals.push_back(terminal);
+				};
+				for (int bid : net.block_list) {
+					if (parent[bid] == c) { cluster_net.block_list.push_back(local[bid]); }
+					else { add_terminal(dst[bid].x + dst[bid].width * 0.5, dst[bid].y + dst[bid].height * 0.5); }
+				}
+				if (_cfg.level_fbp_wl == Config::LevelWireLength::BlockAndTerminal) {
+					for (int tid : net.terminal_list) { add_terminal(_ins.get_terminals().at(tid).x_coordinate, _ins.get_terminals().at(tid).y_coordinate); }
+				}
+				if (cluster_net.block_list.size() + cluster_net.terminal_list.size() >= 2) { nets.push_back(move(cluster_net)); }
+			}
+			Instance ins(_env, move(blocks), move(terminals), move(nets), shapes[1][c].width, shapes[1][c].height);
+			Config sub_cfg = subproblem_config(utils::split_seed(utils::split_seed(_cfg.random_seed, MultilevelRefineStream), c));
+			sub_cfg.level_fbp_wl = Config::LevelWireLength::BlockAndTerminal;
+			sub_cfg.fixed_outline = true;
+			double root_area = sqrt(ins.get_total_area()); // 候选宽度取外框宽度附近
+			sub_cfg.ub_scale = shapes[1][c].width / root_area;
+			sub_cfg.lb_scale = 0.9 * sub_cfg.ub_scale;
+			AdaptiveSelecter asa(_env, sub_cfg, ins);
+			asa._deadline.reset(refine_time);
+			asa._deadline.set_parent(&_deadline);
+			asa.run();
+			_profiler.merge(asa._profile);
+			{
+				lock_guard<mutex> guard(_best_mutex);
+				_memory.merge_transient(asa._memory, "subproblem.");
+			}
+			if (asa._dst.empty()) { return; }
+			double old_dist, new_dist;
+			cal_wirelength(ins, layouts[1][c], Config::LevelWireLength::BlockAndTerminal, old_dist);
+			cal_wirelength(ins, asa._dst, Config::LevelWireLength::BlockAndTerminal, new_dist);
+			if (new_dist < old_dist) {
+				layouts[1][c] = asa._dst;
+				++refined_num;
+			}
+		});
+		return refined_num;
+	}
+
+	/// 以拼接得到的整体布局为结果，按块编号索引
+	void set_layout(vector<Rect> dst) {
+		Rect box = bounding_box(dst);
+		double dist;
+		double wirelength = cal_wirelength(_ins, dst, _cfg.level_fbp_wl, dist);
+		_dst.swap(dst);
+		_duration = _deadline.elapsed();
+		_best_width = box.width;
+		_best_area = box.width * box.height;
+		_best_wirelength = wirelength;
+		_best_objective = _cfg.alpha * _best_area + _cfg.beta * dist;
+		_best_fillratio = 1.0 * _ins.get_total_area() / _best_area;
+		_best_whratio = 1.0 * max(box.width, box.height) / min(box.width, box.height);
+		_improvements.push_back({ _duration, _best_objective, _best_area, _best_wirelength });
+	}
+
+	/// 放置的矩形相对原尺寸转置(正方形视为未转置)
+	static bool is_rotated(const Rect& placed, const Rect& shape) { return placed.width != shape.width; }
+
+	static Rect bounding_box(const vector<Rect>& dst) {
+		Rect box{ 0, 0, 0, 0, 0 };
+		for (auto& rect : dst) {
+			box.width = max(box.width, rect.x + rect.width);
+			box.height = max(box.height, rect.y + rect.height);
+		}
+		return box;
+	}
+
+	/// 与packer相同的线长及距离项，按线网而非块对矩阵计算，适用于大规模算例；同样在两倍坐标系中用整数累加
+	double cal_wirelength(const Instance& ins, const vector<Rect>& dst, Config::LevelWireLength level_wl, double& dist) const {
+		auto pin = [&dst](int bid) { return make_pair(2 * dst[bid].x + dst[bid].width, 2 * dst[bid].y + dst[bid].height); };
+		long long total_wirelength2 = 0;
+		for (auto& net : ins.get_netlist()) {
+			int max_x = INT_MIN, min_x = INT_MAX;
+			int max_y = INT_MIN, min_y = INT_MAX;
+			for (int bid : net.block_list) {
+				auto xy = pin(bid);
+				max_x = max(max_x, xy.first); min_x = min(min_x, xy.first);
+				max_y = max(max_y, xy.second); min_y = min(min_y, xy.second);
+			}
+			if (level_wl == Config::LevelWireLength::BlockAndTerminal) {
+				for (int tid : net.terminal_list) {
+					int pad_x = 2 * ins.get_terminals().at(tid).x_coordinate, pad_y = 2 * ins.get_terminals().at(tid).y_coordinate;
+					max_x = max(max_x, pad_x); min_x = min(min_x, pad_x);
+					max_y = max(max_y, pad_y); min_y = min(min_y, pad_y);
+				}
+			}
+			if (min_x <= max_x) { total_wirelength2 += static_cast<long long>(max_x) - min_x + max_y - min_y; }
+		}
+		long long dist4 = 0;
+		if (_cfg.level_fbp_dist == Config::LevelObjDist::WireLengthDist) { dist4 = 2 * total_wirelength2; }
+		else { // 相连的块对只计一次
+			unordered_set<long long> pairs;
+			for (auto& net : ins.get_netlist()) {
+				for (int i = 0; i < net.block_list.size(); ++i) {
+					for (int j = i + 1; j < net.block_list.size(); ++j) {
+						int a = min(net.block_list[i], net.block_list[j]), b = max(net.block_list[i], net.block_list[j]);
+						if (a == b || !pairs.insert(1LL * a * ins.get_block_num() + b).second) { continue; }
+						long long dx = abs(pin(a).first - pin(b).first), dy = abs(pin(a).second - pin(b).second);
+						dist4 += _cfg.level_fbp_dist == Config::LevelObjDist::SqrEuclideanDist ? dx * dx + dy * dy : (dx + dy) * (dx + dy);
+					}
+				}
 			}
 		}
-		return vector<int>(candidate_widths.begin(), candidate_widths.end());
+		dist = dist4 / 4.0;
+		return total_wirelength2 / 2.0;
+	}
+
+	/// 热启动：读入上次输出的.fp解，恢复朝向，得到对应的候选宽度(不在候选集中则加入)和左下角一致的序列(按y、x排序)
+	void load_warm_start(vector<int>& candidate_widths) {
+		string fp_path = _env.fp_path();
+		vector<Rect> dst;
+		vector<bool> is_read;
+		if (!read_fp(fp_path, dst, is_read)) {
+			fprintf(stderr, "%s: no solution to warm start from.\n", fp_path.c_str());
+			return;
+		}
+		if (find(is_read.begin(), is_read.end(), false) != is_read.end() || !infer_orientations(dst, is_read)) {
+			fprintf(stderr, "%s: incomplete or overlapping solution, warm start skipped.\n", fp_path.c_str());
+			return;
+		}
+		int width = 0, height = 0;
+		for (auto& rect : dst) {
+			width = max(width, rect.x + rect.width);
+			height = max(height, rect.y + rect.height);
+		}
+		if (_cfg.fixed_outline && (width > _ins.get_fixed_width() || height > _ins.get_fixed_height())) {
+			fprintf(stderr, "%s: solution exceeds the outline, warm start skipped.\n", fp_path.c_str());
+			return;
+		}
+		vector<int> sequence(dst.size());
+		iota(sequence.begin(), sequence.end(), 0);
+		sort(sequence.begin(), sequence.end(), [&dst](int lhs, int rhs) {
+			return dst[lhs].y < dst[rhs].y || (dst[lhs].y == dst[rhs].y && dst[lhs].x < dst[rhs].x); });
+		auto pos = lower_bound(candidate_widths.begin(), candidate_widths.end(), width);
+		if (pos == candidate_widths.end() || *pos != width) { candidate_widths.insert(pos, width); }
+		_warm_dst.swap(dst);
+		_warm_sequence.swap(sequence);
+		_warm_width = width;
+		fprintf(stdout, "%s: warm start on width %d.\n", fp_path.c_str(), width);
+	}
+
+	/// 增量重布局：受影响的块为.eco中列出的块(尺寸或线网有变化)、.fp中没有的新块、以及按新尺寸与其他块重叠的块；
+	/// 未受影响的块按(y, x)排序，首个受影响块旧位置以下的前缀固定不动，后缀与受影响块在原宽度上重新打包
+	bool load_eco(vector<int>& candidate_widths) {
+		string fp_path = _env.fp_path();
+		vector<Rect> dst;
+		vector<bool> is_read;
+		if (!read_fp(fp_path, dst, is_read)) {
+			fprintf(stderr, "%s: no previous solution for eco.\n", fp_path.c_str());
+			return false;
+		}
+		unordered_map<string, int> block_ids;
+		for (int i = 0; i < _ins.get_block_num(); ++i) { block_ids[_ins.get_blocks().at(i).name] = i; }
+		vector<bool> is_affected(dst.size(), false);
+		ifstream eco_file(_env.eco_path());
+		string name;
+		while (eco_file >> name) {
+			auto iter = block_ids.find(name);
+			if (iter != block_ids.end()) { is_affected[iter->second] = true; }
+			else { fprintf(stderr, "%s: unknown block %s.\n", _env.eco_path().c_str(), name.c_str()); }
+		}
+		vector<bool> is_placed(dst.size());
+		for (int i = 0; i < dst.size(); ++i) { is_placed[i] = is_read[i] && !is_affected[i]; }
+		infer_orientations(dst, is_placed);
+		for (int i = 0; i < dst.size(); ++i) { // 新尺寸下仍然重叠：视为尺寸有变化
+			for (int j = 0; j < dst.size() && is_placed[i]; ++j) {
+				if (j != i && is_placed[j] && !DisjointRects::disjoint(dst[i], dst[j])) { is_affected[i] = true; }
+			}
+		}
+		int width = 0, cut_y = numeric_limits<int>::max(), affected_num = 0;
+		vector<int> kept;
+		for (int i = 0; i < dst.size(); ++i) {
+			if (!is_affected[i] && is_read[i]) { // 沿用未受影响部分的宽度
+				kept.push_back(i);
+				width = max(width, dst[i].x + dst[i].width);
+				continue;
+			}
+			is_affected[i] = true;
+			++affected_num;
+			if (is_read[i]) { cut_y = min(cut_y, dst[i].y); }
+		}
+		if (affected_num == 0) {
+			fprintf(stderr, "%s: no block is affected, eco skipped.\n", _env.eco_path().c_str());
+			return false;
+		}
+		sort(kept.begin(), kept.end(), [&dst](int lhs, int rhs) {
+			return dst[lhs].y < dst[rhs].y || (dst[lhs].y == dst[rhs].y && dst[lhs].x < dst[rhs].x); });
+		// 新块没有旧位置，至少让同样数目的未受影响块一起重新打包，使新块能嵌入布局而不只是堆在顶上
+		int fixed_num = max(0, min<int>(kept.size() - affected_num,
+			distance(kept.begin(), find_if(kept.begin(), kept.end(), [&](int i) { return dst[i].y >= cut_y; }))));
+		vector<bool> is_fixed(dst.size(), false);
+		for (int k = 0; k < fixed_num; ++k) { is_fixed[kept[k]] = true; }
+		vector<Rect> src = _ins.get_rects();
+		for (int i = 0; i < dst.size(); ++i) {
+			if (!is_fixed[i]) { width = max(width, min(src[i].width, src[i].height)); }
+		}
+		if (_cfg.fixed_outline && width > _ins.get_fixed_width()) {
+			fprintf(stderr, "%s: solution exceeds the outline, eco skipped.\n", fp_path.c_str());
+			return false;
+		}
+		candidate_widths.assign(1, width);
+		_eco_dst.swap(dst);
+		_eco_fixed.swap(is_fixed);
+		_deadline.reset(_cfg.eco_time, _deadline.elapsed());
+		fprintf(stdout, "%s: eco keeps %d blocks, re-packs %d (%d affected) on width %d.\n", fp_path.c_str(),
+			fixed_num, _ins.get_block_num() - fixed_num, affected_num, width);
+		return true;
+	}
+
+	/// 读入.fp解：按块名对应，已删除的块忽略，空行之后是terminal；`is_read`标记读到的块
+	bool read_fp(const string& fp_path, vector<Rect>& dst, vector<bool>& is_read) const {
+		ifstream fp_file(fp_path);
+		if (!fp_file) { return false; }
+		unordered_map<string, int> block_ids;
+		for (int i = 0; i < _ins.get_block_num(); ++i) { block_ids[_ins.get_blocks().at(i).name] = i; }
+		dst = _ins.get_rects();
+		is_read.assign(dst.size(), false);
+		string line;
+		while (getline(fp_file, line)) {
+			if (!line.empty() && line.back() == '\r') { line.pop_back(); }
+			if (line.empty()) { break; }
+			istringstream line_stream(line);
+			string name;
+			int x, y;
+			if (!(line_stream >> name >> x >> y)) { break; }
+			auto iter = block_ids.find(name);
+			if (iter == block_ids.end()) { continue; }
+			dst[iter->second].x = x;
+			dst[iter->second].y = y;
+			is_read[iter->second] = true;
+		}
+		return true;
+	}
+
+	/// .fp只记录左下角坐标：从原朝向出发，反复翻转与其他块重叠的块(翻转后重叠变少才保留)，直到没有重叠；只考虑`is_placed`的块
+	bool infer_orientations(vector<Rect>& dst, const vector<bool>& is_placed) const {
+		auto overlap_num = [&](int i) {
+			int num = 0;
+			for (int j = 0; j < dst.size(); ++j) {
+				if (j != i && is_placed[j] && !DisjointRects::disjoint(dst[i], dst[j])) { ++num; }
+			}
+			return num;
+		};
+		for (int pass = 0; pass < 16; ++pass) {
+			bool is_disjoint = true, is_changed = false;
+			for (int i = 0; i < dst.size(); ++i) {
+				if (!is_placed[i]) { continue; }
+				int old_num = overlap_num(i);
+				if (old_num == 0) { continue; }
+				is_disjoint = false;
+				swap(dst[i].width, dst[i].height);
+				if (overlap_num(i) < old_num) { is_changed = true; }
+				else { swap(dst[i].width, dst[i].height); }
+			}
+			if (is_disjoint) { return true; }
+			if (!is_changed) { return false; }
+		}
+		return false;
+	}
+
+	/// 宽度`bin_width`下的目标函数下界：面积下界，加上与宽度无关的距离项下界
+	/// 高度不低于总面积/W，也不低于每个块在宽度W内的最小高度(长边超过W时必须竖放)
+	double cal_lower_bound(const vector<Rect>& src, int bin_width) const {
+		int height = (_ins.get_total_area() + bin_width - 1) / bin_width;
+		for (auto& rect : src) {
+			int short_side = min(rect.width, rect.height), long_side = max(rect.width, rect.height);
+			height = max(height, long_side > bin_width ? long_side : short_side);
+		}
+		return _cfg.alpha * bin_width * height + _cfg.beta * _dist_lower_bound;
+	}
+
+	/// 互不重叠的两块，中心的曼哈顿距离(以及欧氏距离)不小于两者短边之和的一半
+	double cal_dist_lower_bound() const {
+		const auto& blocks = _ins.get_blocks();
+		auto short_side = [&](int bid) { return min(blocks.at(bid).width, blocks.at(bid).height); };
+		double dist = 0;
+		if (_cfg.level_fbp_dist == Config::LevelObjDist::WireLengthDist) {
+			for (auto& net : _ins.get_netlist()) { // 线网的hpwl不小于其中短边最大的两块的下界
+				int first = 0, second = 0;
+				for (int bid : net.block_list) {
+					int side = short_side(bid);
+					if (side > first) { second = first; first = side; }
+					else if (side > second) { second = side; }
+				}
+				if (net.block_list.size() >= 2) { dist += 0.5 * (first + second); }
+			}
+		}
+		else { // 平方距离按相连的块对计算，每对只计一次
+			unordered_set<long long> pairs;
+			for (auto& net : _ins.get_netlist()) {
+				for (int i = 0; i < net.block_list.size(); ++i) {
+					for (int j = i + 1; j < net.block_list.size(); ++j) {
+						int a = min(net.block_list[i], net.block_list[j]), b = max(net.block_list[i], net.block_list[j]);
+						if (a == b || !pairs.insert(1LL * a * _ins.get_block_num() + b).second) { continue; }
+						double d = 0.5 * (short_side(a) + short_side(b));
+						dist += d * d;
+					}
+				}
+			}
+		}
+		return dist;
+	}
+
+	/// 删除下界已不优于当前最优解的候选宽度，删除后重建选择分布；全部可删时由下界终止条件结束搜索
+	void prune_candidate_widths(vector<CandidateWidth>& cw_objs, SearchContext& ctx) {
+		double best_objective;
+		{
+			lock_guard<mutex> guard(_best_mutex);
+			best_objective = _best_objective;
+		}
+		auto is_hopeless = [best_objective](const CandidateWidth& cw_obj) { return cw_obj.lower_bound >= best_objective; };
+		size_t hopeless_num = count_if(cw_objs.begin(), cw_objs.end(), is_hopeless);
+		if (hopeless_num == 0 || hopeless_num == cw_objs.size()) { return; }
+		cw_objs.erase(remove_if(cw_objs.begin(), cw_objs.end(), is_hopeless), cw_objs.end());
+		ctx.resize(cw_objs.size());
+	}
+
+	/// 固定边框模式下宽度`bin_width`的高度上界：边框高度，以及面积项已不优于当前最优解的高度(距离项非负)
+	int height_bound(int bin_width) {
+		if (!_cfg.fixed_outline) { return INF; }
+		lock_guard<mutex> guard(_best_mutex);
+		int height = _ins.get_fixed_height();
+		if (_cfg.alpha > 0 && _best_objective < numeric_limits<double>::max()) {
+			height = static_cast<int>(min<double>(height, floor(_best_objective / (_cfg.alpha * bin_width))));
+		}
+		return height;
+	}
+
+	/// 搜索结束时汇总各packer的打包计数及内存占用
+	void collect_packer_stats(const vector<CandidateWidth>& cw_objs) {
+		lock_guard<mutex> guard(_best_mutex);
+		for (auto& cw_obj : cw_objs) {
+			_pack_num += cw_obj.fbp_solver->get_pack_num();
+			_prune_num += cw_obj.fbp_solver->get_prune_num();
+			cw_obj.fbp_solver->account_memory(_memory);
+		}
+	}
+
+	/// 到达检查点间隔时序列化搜索状态，交给后台线程写出；检查点总在两次`adaptive_step`之间，恢复后与不中断的搜索一致
+	void checkpoint(const SearchContext& ctx, const vector<PackerArm>& arms) {
+		if (_cfg.checkpoint_interval <= 0 || _deadline.elapsed() < _next_checkpoint) { return; }
+		if (_deadline.expired() || !ctx.has_budget()) { return; } // 最后一步被抢占，求解器的断点状态不在检查点中
+		if (!_checkpoint_writer) { _checkpoint_writer = make_unique<utils::AsyncFileWriter>(_env.checkpoint_path(_cfg.random_seed)); }
+		_checkpoint_writer->post(save_checkpoint(ctx, arms));
+		_next_checkpoint = _deadline.elapsed() + _cfg.checkpoint_interval;
+	}
+
+	static const char* packer_name(Config::LevelFloorplanPacker packer) {
+		return packer == Config::LevelFloorplanPacker::BeamSearch ? "BeamSearch" : "RandomLocalSearch";
+	}
+
+	/// 收敛轨迹：每行一个JSON对象，由后台线程追加写出，首行记录算例和与调度相关的参数；从检查点恢复时接在上次的轨迹之后
+	void start_trace(const vector<int>& candidate_widths) {
+		_trace_writer = make_unique<utils::AsyncAppendWriter>(_env.trace_path(_cfg.random_seed), _cfg.resume);
+		char buf[512];
+		snprintf(buf, sizeof(buf), "{\"time\":%.6f,\"event\":\"start\",\"instance\":\"%s\",\"seed\":%u,\"alpha\":%g,\"beta\":%g,"
+			"\"ub_iter\":%d,\"ub_time\":%d,\"width_num\":%zu,\"min_width\":%d,\"max_width\":%d}\n",
+			_deadline.elapsed(), _env._ins_name.c_str(), _cfg.random_seed, _cfg.alpha, _cfg.beta, _cfg.ub_iter, _cfg.ub_time, candidate_widths.size(),
+			candidate_widths.empty() ? 0 : *min_element(candidate_widths.begin(), candidate_widths.end()),
+			candidate_widths.empty() ? 0 : *max_element(candidate_widths.begin(), candidate_widths.end()));
+		_trace_writer->append(buf);
+	}
+
+	/// `event`为best时是全局最优解的改进，为improve时是被选中宽度自身的改进；iter对rls为交换次数，对bs为束宽度
+	void trace_improvement(const char* event, const CandidateWidth& cw_obj) {
+		char buf[256];
+		snprintf(buf, sizeof(buf), "{\"time\":%.6f,\"event\":\"%s\",\"packer\":\"%s\",\"width\":%d,\"iter\":%d,"
+			"\"area\":%d,\"wirelength\":%.17g,\"objective\":%.17g}\n",
+			_deadline.elapsed(), event, packer_name(cw_obj.packer), cw_obj.value, cw_obj.iter,
+			cw_obj.fbp_solver->get_area(), cw_obj.fbp_solver->get_wirelength(), cw_obj.fbp_solver->get_objective());
+		_trace_writer->append(buf);
+	}
+
+	bool is_trace_due(SearchContext& ctx) const {
+		if (!_trace_writer || _deadline.elapsed() < ctx.next_trace) { return false; }
+		ctx.next_trace = _deadline.elapsed() + _cfg.trace_interval;
+		return true;
+	}
+
+	/// 各候选宽度的[宽度, 访问次数, iter, 目标函数]，按宽度升序；岛屿模型下附带岛屿编号
+	void trace_visits(const vector<CandidateWidth>& cw_objs, int island_id = -1) {
+		if (cw_objs.empty()) { return; }
+		vector<const CandidateWidth*> sorted_objs; sorted_objs.reserve(cw_objs.size());
+		for (auto& cw_obj : cw_objs) { sorted_objs.push_back(&cw_obj); }
+		sort(sorted_objs.begin(), sorted_objs.end(), [](auto lhs, auto rhs) { return lhs->value < rhs->value; });
+		ostringstream os;
+		os << setprecision(17) << "{\"time\":" << _deadline.elapsed() << ",\"event\":\"visits\",\"packer\":\"" << packer_name(cw_objs.front().packer) << '"';
+		if (island_id >= 0) { os << ",\"island\":" << island_id; }
+		os << ",\"widths\":[";
+		for (auto cw_obj : sorted_objs) {
+			os << (cw_obj == sorted_objs.front() ? "[" : ",[") << cw_obj->value << ',' << cw_obj->visit_num << ',' << cw_obj->iter << ','
+				<< cw_obj->fbp_solver->get_objective() << ']';
+		}
+		os << "]}\n";
+		_trace_writer->append(os.str());
+	}
+
+	string save_checkpoint(const SearchContext& ctx, const vector<PackerArm>& arms) const {
+		ostringstream os;
+		os << setprecision(17) << "asa " << _cfg.random_seed << ' ' << static_cast<int>(_cfg.level_asa_fbp) << ' '
+			<< _ins.get_block_num() << ' ' << arms.size() << '\n';
+		os << _deadline.elapsed() << ' ' << total_step_budget() - ctx.step_budget << ' ' << ctx.gen << '\n';
+		os << _duration << ' ' << _iteration << ' ' << _best_area << ' ' << _best_wirelength << ' ' << _best_objective << ' '
+			<< _best_fillratio << ' ' << _best_whratio << ' ' << _best_width << ' ' << _dst.size();
+		for (auto& rect : _dst) { os << ' ' << rect.id << ' ' << rect.x << ' ' << rect.y << ' ' << rect.width << ' ' << rect.height; }
+		os << '\n';
+		for (auto& arm : arms) {
+			os << arm.gain << ' ' << arm.cost << ' ' << arm.total_cost << ' ' << arm.cw_objs.size() << '\n';
+			for (auto& cw_obj : arm.cw_objs) {
+				os << cw_obj.value << ' ' << cw_obj.iter << ' ';
+				cw_obj.fbp_solver->save(os);
+			}
+		}
+		return os.str();
+	}
+
+	/// 从检查点恢复全部搜索状态；检查点不存在、与当前算例/参数不匹配或已损坏时不做任何修改，返回false
+	bool load_checkpoint(const vector<Rect>& src, SearchContext& ctx, vector<PackerArm>& arms) {
+		string ckpt_path = _env.checkpoint_path(_cfg.random_seed);
+		ifstream ckpt_file(ckpt_path);
+		if (!ckpt_file) {
+			fprintf(stderr, "%s: no checkpoint, start from scratch.\n", ckpt_path.c_str());
+			return false;
+		}
+		string tag;
+		unsigned int random_seed = 0;
+		int packer = -1, block_num = 0;
+		size_t arm_num = 0;
+		ckpt_file >> tag >> random_seed >> packer >> block_num >> arm_num;
+		if (tag != "asa" || random_seed != _cfg.random_seed || packer != static_cast<int>(_cfg.level_asa_fbp)
+			|| block_num != _ins.get_block_num() || arm_num != arms.size()) {
+			fprintf(stderr, "%s: checkpoint mismatch, start from scratch.\n", ckpt_path.c_str());
+			return false;
+		}
+
+		double elapsed = 0;
+		long long used_steps = 0;
+		SearchContext loaded_ctx(ctx);
+		ckpt_file >> elapsed >> used_steps >> ws >> loaded_ctx.gen; // libstdc++读取随机引擎时不跳过空白
+		loaded_ctx.step_budget = total_step_budget() - used_steps;
+
+		double duration = 0, best_wirelength = 0, best_objective = 0, best_fillratio = 0, best_whratio = 0;
+		int iteration = 0, best_area = 0, best_width = 0;
+		size_t dst_size = 0;
+		ckpt_file >> duration >> iteration >> best_area >> best_wirelength >> best_objective
+			>> best_fillratio >> best_whratio >> best_width >> dst_size;
+		vector<Rect> dst(ckpt_file ? dst_size : 0);
+		for (auto& rect : dst) { ckpt_file >> rect.id >> rect.x >> rect.y >> rect.width >> rect.height; }
+
+		vector<PackerArm> loaded_arms;
+		for (auto& arm : arms) {
+			loaded_arms.push_back({ arm.packer });
+			PackerArm& loaded_arm = loaded_arms.back();
+			size_t cw_num = 0;
+			ckpt_file >> loaded_arm.gain >> loaded_arm.cost >> loaded_arm.total_cost >> cw_num;
+			for (size_t i = 0; ckpt_file && i < cw_num; ++i) {
+				int value = 0, iter = 0;
+				if (!(ckpt_file >> value >> iter)) { break; }
+				loaded_arm.cw_objs.push_back({ value, iter, make_packer(arm.packer, src, value), cal_lower_bound(src, value), arm.packer });
+				loaded_arm.cw_objs.back().fbp_solver->set_deadline(&_deadline);
+				loaded_arm.cw_objs.back().fbp_solver->load(ckpt_file);
+			}
+		}
+		if (!ckpt_file) {
+			fprintf(stderr, "%s: broken checkpoint, start from scratch.\n", ckpt_path.c_str());
+			return false;
+		}
+
+		loaded_ctx.resize(loaded_arms.front().cw_objs.size()); // 保存时可能已删除部分候选宽度
+		ctx = loaded_ctx;
+		arms.swap(loaded_arms);
+		_duration = duration;
+		_iteration = iteration;
+		_best_area = best_area;
+		_best_wirelength = best_wirelength;
+		_best_objective = best_objective;
+		_best_fillratio = best_fillratio;
+		_best_whratio = best_whratio;
+		_best_width = best_width;
+		_dst.swap(dst);
+		if (!_dst.empty()) { _improvements.push_back({ _duration, _best_objective, _best_area, _best_wirelength }); }
+		_deadline.reset(_cfg.ub_time, elapsed);
+		_next_checkpoint = elapsed + _cfg.checkpoint_interval;
+		fprintf(stdout, "%s: resume at %.2fs, objective %f.\n", ckpt_path.c_str(), elapsed, _best_objective);
+		return true;
+	}
+
+	/// 按步数终止时，结果对给定的(随机种子, 线程数)可复现
+	bool is_deterministic() const { return _cfg.ub_step > 0; }
+
+	long long total_step_budget() const { return is_deterministic() ? _cfg.ub_step : numeric_limits<long long>::max(); }
+
+	/// 随机流的派生关系，记录在日志中用于复现
+	string seed_tree() const {
+		ostringstream os;
+		os << "root=" << _cfg.random_seed
+			<< ";selector=" << utils::split_seed(_cfg.random_seed, SelectorStream)
+			<< ";rls=" << utils::split_seed(_cfg.random_seed, RlsStream) << "/width"
+			<< ";bs=" << utils::split_seed(_cfg.random_seed, BsStream) << "/width/run/level"
+			<< ";island=" << utils::split_seed(_cfg.random_seed, IslandStream) << "/id"
+			<< ";threads=" << (_cfg.level_asa_fbp == Config::LevelFloorplanPacker::RandomLocalSearch ? max(1, _cfg.island_num) : 1)
+			<< ";steps=" << _cfg.ub_step;
+		return os.str();
 	}
 
 	/// 在区间[W_min, W_max]内，等距地生成候选宽度
@@ -237,10 +1439,13 @@ private:
 		return candidate_widths;
 	}
 
+	/// 岛屿模型下由多个线程调用；目标函数相同时取较小的宽度，使最终结果与更新顺序无关
 	void update_objective(const CandidateWidth& cw_obj) {
+		lock_guard<mutex> guard(_best_mutex);
+		double objective = cw_obj.fbp_solver->get_objective();
 		//if (_best_area > cw_obj.fbp_solver->get_area() && _best_wirelength > cw_obj.fbp_solver->get_wirelength())
-		if (_best_objective > cw_obj.fbp_solver->get_objective() + numeric_limits<double>::epsilon()) {
-			_duration = static_cast<double>(clock() - _start) / CLOCKS_PER_SEC;
+		if (objective < _best_objective || (objective == _best_objective && cw_obj.value < _best_width)) {
+			_duration = _deadline.elapsed();
 			_iteration = cw_obj.iter;
 			_best_objective = cw_obj.fbp_solver->get_objective();
 			_best_area = cw_obj.fbp_solver->get_area();
@@ -248,8 +1453,29 @@ private:
 			_best_fillratio = 1.0 * _ins.get_total_area() / _best_area;
 			int cw_height = _best_area / cw_obj.value;
 			_best_whratio = 1.0 * max(cw_obj.value, cw_height) / min(cw_obj.value, cw_height);
+			_best_width = cw_obj.value;
 			_dst = cw_obj.fbp_solver->get_dst();
+			_improvements.push_back({ _duration, _best_objective, _best_area, _best_wirelength });
+			if (_trace_writer) { trace_improvement("best", cw_obj); }
+			if (_target_duration < 0 && is_target_reached()) { // 达到目标即停止，所有求解器在下一步之前被抢占
+				_target_duration = _duration;
+				_target_iteration = _iteration;
+				_deadline.cancel();
+				if (!_cfg.quiet) { fprintf(stdout, "%s: target reached at %.3fs, iteration %d.\n", _env._ins_name.c_str(), _target_duration, _target_iteration); }
+			}
+			if (_best_objective <= (1 + _cfg.lb_gap) * _lower_bound) { _deadline.cancel(); } // 已可证明与最优的差距在lb_gap以内
+		}
+	}
+
+	/// 绝对目标：目标函数值；比例目标：按`obj_map`参考面积、线长归一化的加权得分
+	bool is_target_reached() const {
+		if (_cfg.target_objective > 0 && _best_objective <= _cfg.target_objective) { return true; }
+		auto ref = obj_map.find(_env._ins_name);
+		if (_cfg.target_ratio > 0 && ref != obj_map.end()) {
+			double score = (_cfg.alpha * _best_area / ref->second.first + _cfg.beta * _best_wirelength / ref->second.second) / (_cfg.alpha + _cfg.beta);
+			return score <= _cfg.target_ratio;
 		}
+		return false;
 	}
 
 	/// 解的合法性检查
@@ -276,8 +1502,7 @@ private:
 	const Config& _cfg;
 
 	Instance _ins;
-	default_random_engine _gen;
-	clock_t _start;
+	utils::Deadline _deadline; // 墙钟截止时间，超时后求解器在一步之内被抢占
 	double _duration;
 	int _iteration;
 
@@ -286,5 +1511,30 @@ private:
 	double _best_objective;
 	double _best_fillratio;
 	double _best_whratio;
+	int _best_width;
 	vector<Rect> _dst;
+	vector<Improvement> _improvements;
+	mutex _best_mutex;
+	ParetoArchive _archive; // cfg.pareto_archive开启时由所有packer共享
+	vector<Rect> _warm_dst; // 热启动载入的解
+	vector<int> _warm_sequence;
+	int _warm_width;
+	vector<Rect> _eco_dst; // 增量重布局的上次解及固定块
+	vector<bool> _eco_fixed;
+	double _dist_lower_bound; // 距离项下界，与宽度无关
+	double _lower_bound;      // 所有候选宽度下界的最小值
+	double _target_duration; // 达到目标的时间(秒)，未达到为-1
+	int _target_iteration;
+	long long _pack_num;  // 固定边框模式：已评估的打包数目
+	long long _prune_num; // 其中超出高度上界的数目
+
+	double _run_time; // 本次求解的墙钟时间，含初始化
+	utils::Profiler::Session _profiler; // 本次求解的计时，含岛屿线程和子问题
+	utils::Profiler::Counters _profile;
+	utils::MemoryUsage _memory;
+	long long _peak_rss;
+
+	unique_ptr<utils::AsyncFileWriter> _checkpoint_writer; // 首次保存检查点时创建
+	double _next_checkpoint;
+	unique_ptr<utils::AsyncAppendWriter> _trace_writer; // cfg.trace_interval > 0时在搜索期间存在
 };
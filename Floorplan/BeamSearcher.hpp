@@ -12,11 +12,12 @@ namespace fbp {
 
 	class BeamSearcher : public FloorplanPacker {
 
+		friend class MicroBenchmark;
+
 		/// òڵ㶨
 		struct BeamNode {
-			vector<Rect> dst; // ѷþΣpartial/complete solution
-			list<int> rects;  // δþ
-			vector<bool> is_packed;
+			Placement placement; // ѷþΣpartial/complete solution
+			vector<int> rects; // δþΣƸֵʱ
 			Netwire netwire;
 			Skyline skyline;
 			int bl_index = 0; // bottom_left_skyline_index
@@ -36,21 +37,52 @@ namespace fbp {
 			double lookahead_eval; // ǰĿ꺯min
 		};
 
+		/// ʱֵֽȡвֵ
+		struct LevelMemory {
+			long long beam_tree = 0;       // ǰ
+			long long filter_children = 0; // ֲѡӽڵ
+			long long beam_children = 0;   // ȫѡӽڵ
+			long long copies = 0;          // һȫеĽڵ㸱
+		};
+
+		/// 㸴õĻͬһ߳ڵBeamSearcher̬ÿ㲻ٴӶϷ
+		/// ̶߳ǰʵУռֻȡڵrunѡȵĿ޹
+		struct LevelBuffers {
+			vector<BranchNode> children;
+			vector<BranchNode> filter_children;
+			vector<BranchNode> beam_children;
+			vector<int> area_rank;
+			vector<int> wire_rank;
+			vector<BeamNode> next_beam_tree;
+			vector<BeamNode> node_pool; // нڵ㣬ڲvector
+			BeamNode eval_node;         // ȫʱ̰Ĳȫĸ
+		};
+
 	public:
 		BeamSearcher() = delete;
 
-		BeamSearcher(const Instance& ins, const vector<Rect>& src, int bin_width, default_random_engine& gen) :
-			FloorplanPacker(ins, src, bin_width, gen) {}
+		BeamSearcher(const Instance& ins, const vector<Rect>& src, int bin_width, unsigned int seed) :
+			FloorplanPacker(ins, src, bin_width, seed), _run_count(0) {}
 
-		void run(int beam_width, double alpha, double beta, Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
-			reset_beam_tree();
+		bool run(int beam_width, double alpha, double beta, Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			if (!_is_pending) {
+				reset_beam_tree();
+				_run_beam_width = beam_width;
+				++_run_count;
+			}
+			beam_width = _run_beam_width;
+			_is_pending = true; // ռʱ_beam_tree´εôӵǰ
 			int filter_width = beam_width * 2;
+			LevelBuffers& buffers = level_buffers();
 			while (!_beam_tree.front().rects.empty()) {
-				vector<BranchNode> filter_children; filter_children.reserve(filter_width);
+				// ÿʹ(ִ, )ռӶϵĽһͬ
+				default_random_engine level_gen(utils::split_seed(utils::split_seed(_seed, _run_count), _src.size() - _beam_tree.front().rects.size()));
+				vector<BranchNode>& filter_children = buffers.filter_children; filter_children.clear();
 				int nth_filter_width = filter_width / _beam_tree.size();
 				for (auto& parent : _beam_tree) {
 					check_parent(parent);
-					vector<BranchNode> children = branch(parent, level_dist);
+					vector<BranchNode>& children = buffers.children;
+					branch(parent, level_dist, children);
 					if (children.size() > nth_filter_width) {
 						// 1.ֲȫӽڵѡ`filter_width`ÿڵ㹱`nth_filter_width`
 						local_evaluation(children, alpha, beta);
@@ -60,26 +92,26 @@ namespace fbp {
 						// ɢԣMSVC`nth_element`Ϊȫʵ֣򶵵
 						double nth_local_eval = nth_iter->local_eval;
 						while (nth_iter != children.end() && nth_iter->local_eval == nth_local_eval) { nth_iter = next(nth_iter); }
-						shuffle(children.begin(), nth_iter, _gen);
+						shuffle(children.begin(), nth_iter, level_gen);
 						filter_children.insert(filter_children.end(), children.begin(), children.begin() + nth_filter_width);
 					}
 					else { // `nth_filter_width`ȫѡ
 						filter_children.insert(filter_children.end(), children.begin(), children.end());
 					}
 				}
-				filter_children.shrink_to_fit();
+				if (filter_children.empty()) { break; } // ӽڵ߶Ͻ磬ûпн
 
-				vector<BranchNode> beam_children; beam_children.reserve(beam_width);
+				vector<BranchNode>& beam_children = buffers.beam_children; beam_children.clear();
 				if (filter_children.size() > beam_width) {
 					if (beam_width == 1) { // `beam_width==1`ѡһȫõ
-						global_evaluation(filter_children, alpha, beta, false, level_wl, level_dist);
+						if (!global_evaluation(filter_children, alpha, beta, false, level_wl, level_dist)) { return false; }
 						auto min_iter = filter_children.begin();
 						int cnt = 1;
 						for (auto iter = filter_children.begin() + 1; iter != filter_children.end(); ++iter) {
-							if (iter->global_eval > min_iter->global_eval + numeric_limits<double>::epsilon()) { continue; }
-							if (abs(iter->global_eval - min_iter->global_eval) <= numeric_limits<double>::epsilon()) {
+							if (iter->global_eval > min_iter->global_eval) { continue; } // ĿֵۼӵõȷȽ
+							if (iter->global_eval == min_iter->global_eval) {
 								++cnt;
-								if (_bernoulli_dist(_gen, bernoulli_distribution::param_type(1.0 / cnt))) { min_iter = iter; }
+								if (_bernoulli_dist(level_gen, bernoulli_distribution::param_type(1.0 / cnt))) { min_iter = iter; }
 							}
 							else {
 								min_iter = iter;
@@ -91,62 +123,162 @@ namespace fbp {
 					else {
 						int nth_beam_width = beam_width / 2;
 						// 2.ȫ`filter_children`ѡ`nth_beam_width`
-						global_evaluation(filter_children, alpha, beta, false, level_wl, level_dist);
+						if (!global_evaluation(filter_children, alpha, beta, false, level_wl, level_dist)) { return false; }
 						auto nth_iter = filter_children.begin() + nth_beam_width - 1;
 						nth_element(filter_children.begin(), nth_iter, filter_children.end(), [](auto& lhs, auto& rhs) {
-							return lhs.global_eval + numeric_limits<double>::epsilon() < rhs.global_eval; });
+							return lhs.global_eval < rhs.global_eval; });
 						double nth_global_eval = nth_iter->global_eval;
 						while (nth_iter != filter_children.end() && nth_iter->global_eval == nth_global_eval) { nth_iter = next(nth_iter); }
-						shuffle(filter_children.begin(), nth_iter, _gen);
+						shuffle(filter_children.begin(), nth_iter, level_gen);
 						beam_children.insert(beam_children.end(), filter_children.begin(), filter_children.begin() + nth_beam_width);
 						// 3.ǰʣ`filter_children`ѡ`nth_beam_width`
-						global_evaluation(filter_children, alpha, beta, true, level_wl, level_dist);
+						if (!global_evaluation(filter_children, alpha, beta, true, level_wl, level_dist)) { return false; }
 						nth_iter = filter_children.begin() + beam_width - 1;
 						nth_element(filter_children.begin() + nth_beam_width, nth_iter, filter_children.end(), [](auto& lhs, auto& rhs) {
-							return lhs.lookahead_eval + numeric_limits<double>::epsilon() < rhs.lookahead_eval; });
+							return lhs.lookahead_eval < rhs.lookahead_eval; });
 						double nth_lookahead_eval = nth_iter->lookahead_eval;
 						while (nth_iter != filter_children.end() && nth_iter->lookahead_eval == nth_lookahead_eval) { nth_iter = next(nth_iter); }
-						shuffle(filter_children.begin() + nth_beam_width, nth_iter, _gen);
+						shuffle(filter_children.begin() + nth_beam_width, nth_iter, level_gen);
 						beam_children.insert(beam_children.end(), filter_children.begin() + nth_beam_width, filter_children.begin() + beam_width);
 					}
 				}
 				else { // `beam_width`ȫѡ
 					beam_children.insert(beam_children.end(), filter_children.begin(), filter_children.end());
 				}
-				beam_children.shrink_to_fit();
 
-				// 4.ִѡжһ
-				vector<BeamNode> new_beam_tree; new_beam_tree.reserve(beam_children.size());
+				// 4.ִѡжһ㣻½ڵȡԽڵأɲĽڵ黹ڵ
+				vector<BeamNode>& new_beam_tree = buffers.next_beam_tree; new_beam_tree.clear();
 				for (auto& child : beam_children) {
-					BeamNode parent_copy = *child.parent;
+					new_beam_tree.push_back(acquire_node());
+					BeamNode& parent_copy = new_beam_tree.back();
+					parent_copy = *child.parent;
 					insert_chosen_rect_for_parent(parent_copy, child.chosen_rect_index,
 						child.chosen_rect_width, child.chosen_rect_height, child.chosen_rect_xcoord);
-					new_beam_tree.push_back(move(parent_copy));
 				}
+				record_level_memory(filter_children, beam_children, new_beam_tree);
+				release_nodes(_beam_tree);
 				new_beam_tree.swap(_beam_tree);
 			}
-			vector<BeamNode>().swap(_beam_tree);
+			release_nodes(_beam_tree);
+			_is_pending = false;
+			return true;
+		}
+
+		void save(ostream& os) const {
+			FloorplanPacker::save(os);
+			os << _run_count << '\n';
+		}
+
+		void account_memory(utils::MemoryUsage& usage) const {
+			FloorplanPacker::account_memory(usage);
+			long long beam_tree = utils::heap_bytes(_beam_tree); // ռʱ
+			for (auto& node : _beam_tree) { beam_tree += node_bytes(node); }
+			usage.resident["bs.beam_tree"] += beam_tree;
+			auto& transient = usage.transient;
+			const LevelBuffers& buffers = level_buffers(); // ̵߳Ļ
+			long long level_buffers_bytes = utils::heap_bytes(buffers.children) + utils::heap_bytes(buffers.filter_children)
+				+ utils::heap_bytes(buffers.beam_children) + utils::heap_bytes(buffers.area_rank) + utils::heap_bytes(buffers.wire_rank)
+				+ utils::heap_bytes(buffers.next_beam_tree) + utils::heap_bytes(buffers.node_pool) + node_bytes(buffers.eval_node);
+			for (auto& node : buffers.node_pool) { level_buffers_bytes += node_bytes(node); }
+			transient["bs.level_buffers"] = max(transient["bs.level_buffers"], level_buffers_bytes);
+			transient["bs.level.beam_tree"] = max(transient["bs.level.beam_tree"], _level_peak.beam_tree);
+			transient["bs.level.filter_children"] = max(transient["bs.level.filter_children"], _level_peak.filter_children);
+			transient["bs.level.beam_children"] = max(transient["bs.level.beam_children"], _level_peak.beam_children);
+			transient["bs.level.copies"] = max(transient["bs.level.copies"], _level_peak.copies);
+		}
+
+		bool load(istream& is) {
+			if (!FloorplanPacker::load(is)) { return false; }
+			is >> _run_count;
+			return static_cast<bool>(is);
+		}
+
+		/// ·һ֧⣬ÿڿɷõӽڵѡǰĿ飬ڵǰ
+		bool accept_sequence(const vector<int>& sequence, double alpha, double beta,
+			Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			if (_is_pending) { return false; }
+			reset_beam_tree();
+			BeamNode& node = _beam_tree.front();
+			vector<int> rank(_src.size());
+			for (int i = 0; i < sequence.size(); ++i) { rank[sequence[i]] = i; }
+			vector<BranchNode>& children = level_buffers().children;
+			while (!node.rects.empty()) {
+				check_parent(node);
+				branch(node, level_dist, children);
+				if (children.empty()) { // ߶Ͻ
+					release_nodes(_beam_tree);
+					return false;
+				}
+				auto chosen = min_element(children.begin(), children.end(), [&rank](auto& lhs, auto& rhs) {
+					return rank[lhs.chosen_rect_index] < rank[rhs.chosen_rect_index]
+						|| (rank[lhs.chosen_rect_index] == rank[rhs.chosen_rect_index] && lhs.area_score > rhs.area_score); });
+				insert_chosen_rect_for_parent(node, chosen->chosen_rect_index, chosen->chosen_rect_width, chosen->chosen_rect_height, chosen->chosen_rect_xcoord);
+			}
+			int target_area = max_element(node.skyline.begin(), node.skyline.end(), [](auto& lhs, auto& rhs) { return lhs.y < rhs.y; })->y * _bin_width;
+			double target_dist;
+			double target_wirelength = cal_wirelength(node.placement, target_dist, level_wl, level_dist);
+			double old_objective = _objective;
+			update_objective(cal_objective(target_area, target_dist, alpha, beta), target_area, target_wirelength, node.placement);
+			release_nodes(_beam_tree);
+			return _objective < old_objective;
 		}
 
 	private:
+		static LevelBuffers& level_buffers() {
+			static thread_local LevelBuffers buffers;
+			return buffers;
+		}
+
+		/// ӽڵȡһнڵ㣬ؿʱ½
+		static BeamNode acquire_node() {
+			vector<BeamNode>& node_pool = level_buffers().node_pool;
+			if (node_pool.empty()) { return BeamNode(); }
+			BeamNode node = move(node_pool.back());
+			node_pool.pop_back();
+			return node;
+		}
+
+		/// `nodes`ȫڵ黹ڵز`nodes`
+		static void release_nodes(vector<BeamNode>& nodes) {
+			vector<BeamNode>& node_pool = level_buffers().node_pool;
+			for (auto& node : nodes) { node_pool.push_back(move(node)); }
+			nodes.clear();
+		}
+
 		/// ÿε_beam_tree
 		void reset_beam_tree() {
-			_beam_tree.clear();
-			BeamNode root;
-			root.dst = _src;
-			root.rects.resize(_src.size());
-			iota(root.rects.begin(), root.rects.end(), 0);
-			root.is_packed.resize(_src.size(), false);
+			release_nodes(_beam_tree);
+			_beam_tree.push_back(acquire_node());
+			BeamNode& root = _beam_tree.front();
+			root.placement = _base_placement;
+			root.rects.assign(_free_rects.begin(), _free_rects.end());
 			root.netwire.resize(_ins.get_net_num());
 			for_each(root.netwire.begin(), root.netwire.end(), [](auto& netwire_node) {
 				netwire_node.max_x = netwire_node.max_y = 0;
 				netwire_node.min_x = netwire_node.min_y = INF;
-				netwire_node.hpwl = 0.0;
+				netwire_node.hpwl = 0;
 			});
-			root.skyline.clear();
-			root.skyline.push_back({ 0,0,_bin_width });
+			for (int i = 0; i < _src.size(); ++i) {
+				if (_is_fixed[i]) { update_netwire(root, i); }
+			}
+			root.skyline = _base_skyline;
 			root.bl_index = 0;
-			_beam_tree.push_back(move(root));
+		}
+
+		static long long node_bytes(const BeamNode& node) {
+			return utils::heap_bytes(node.placement.x) + utils::heap_bytes(node.placement.y) + utils::heap_bytes(node.placement.flags) + utils::heap_bytes(node.rects)
+				+ utils::heap_bytes(node.netwire) + utils::heap_bytes(node.skyline);
+		}
+
+		/// һɺ滻ɲ֮ǰ¾㼰ӽڵͬʱפ
+		void record_level_memory(const vector<BranchNode>& filter_children, const vector<BranchNode>& beam_children, const vector<BeamNode>& new_beam_tree) {
+			long long beam_tree = utils::heap_bytes(_beam_tree), copies = utils::heap_bytes(new_beam_tree) + node_bytes(_beam_tree.front());
+			for (auto& node : _beam_tree) { beam_tree += node_bytes(node); }
+			for (auto& node : new_beam_tree) { copies += node_bytes(node); }
+			_level_peak.beam_tree = max(_level_peak.beam_tree, beam_tree);
+			_level_peak.filter_children = max(_level_peak.filter_children, utils::heap_bytes(filter_children));
+			_level_peak.beam_children = max(_level_peak.beam_children, utils::heap_bytes(beam_children));
+			_level_peak.copies = max(_level_peak.copies, copies);
 		}
 
 		///  & bl_index
@@ -178,30 +310,34 @@ namespace fbp {
 			parent.bl_index = bottom_skyline_index;
 		}
 
-		/// ֧
-		vector<BranchNode> branch(const BeamNode& parent, Config::LevelObjDist level_dist) {
-			vector<BranchNode> children; children.reserve(parent.rects.size() * 2);
-			for (int r : parent.rects) {
-				for (int rotate = 0; rotate <= 1; ++rotate) {
-					BranchNode child;
-					child.parent = &parent;
-					child.chosen_rect_index = r;
-					child.chosen_rect_width = rotate ? _src.at(r).height : _src.at(r).width;
-					child.chosen_rect_height = rotate ? _src.at(r).width : _src.at(r).height;
-					if (score_area_and_set_xcoord(parent, child.chosen_rect_width, child.chosen_rect_height,
-						child.chosen_rect_xcoord, child.area_score)) {
-						child.wire_score = score_wire(child);
-						children.push_back(move(child));
-					}
-				}
+		/// ֧ӽڵд`children`
+		void branch(const BeamNode& parent, Config::LevelObjDist level_dist, vector<BranchNode>& children) {
+			profile_scope(Branch);
+			children.clear(); children.reserve(parent.rects.size() * 2);
+			// δÿֳһδ֣չŵµ
+			score_gap(skyline_nodo_to_space(parent.skyline, parent.bl_index), parent.rects);
+			const GapFit& fit = _gap_fit;
+			for (int k = 0; k < 2 * fit.size; ++k) {
+				if (fit.scores[k] < 0 || parent.skyline[parent.bl_index].y + fit.heights[k] > _bin_height) { continue; } // ߶ϽӽڵֱӼ
+				BranchNode child;
+				child.parent = &parent;
+				child.chosen_rect_index = fit.rects[k / 2];
+				child.chosen_rect_width = fit.widths[k];
+				child.chosen_rect_height = fit.heights[k];
+				child.chosen_rect_xcoord = fit.xs[k];
+				child.area_score = fit.scores[k];
+				child.wire_score = score_wire(child);
+				children.push_back(move(child));
 			}
-			children.shrink_to_fit();
-			return children;
 		}
 
 		/// ֲ
 		void local_evaluation(vector<BranchNode>& children, double alpha, double beta) {
-			vector<int> area_rank(children.size()), wire_rank(children.size());
+			profile_scope(LocalEvaluation);
+			vector<int>& area_rank = level_buffers().area_rank;
+			vector<int>& wire_rank = level_buffers().wire_rank;
+			area_rank.resize(children.size());
+			wire_rank.resize(children.size());
 			iota(area_rank.begin(), area_rank.end(), 0);
 			iota(wire_rank.begin(), wire_rank.end(), 0);
 			sort(area_rank.begin(), area_rank.end(), [&](int lhs, int rhs) {
@@ -215,83 +351,60 @@ namespace fbp {
 			}
 		}
 
-		/// ȫ or ǰĿ꺯
-		void global_evaluation(vector<BranchNode>& children, double alpha, double beta, bool is_lookahead,
+		/// ȫ or ǰĿ꺯falseʾռ
+		bool global_evaluation(vector<BranchNode>& children, double alpha, double beta, bool is_lookahead,
 			Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			profile_scope(GlobalEvaluation);
 			for (auto& child : children) {
-				BeamNode parent_copy = *child.parent;
+				if (!next_step()) { return false; }
+				BeamNode& parent_copy = level_buffers().eval_node;
+				parent_copy = *child.parent;
 				insert_chosen_rect_for_parent(parent_copy, child.chosen_rect_index,
 					child.chosen_rect_width, child.chosen_rect_height, child.chosen_rect_xcoord);
-				int target_area = greedy_construction(parent_copy, is_lookahead) * _bin_width;
+				int target_height = greedy_construction(parent_copy, is_lookahead);
+				++_pack_num;
+				if (target_height > _bin_height) { // ̰Ĳȫ߶Ͻ磬
+					++_prune_num;
+					(is_lookahead ? child.lookahead_eval : child.global_eval) = numeric_limits<double>::max();
+					continue;
+				}
+				int target_area = target_height * _bin_width;
 				double target_dist;
-				double target_wirelength = cal_wirelength(parent_copy.dst, parent_copy.is_packed, target_dist, level_wl, level_dist);
+				double target_wirelength = cal_wirelength(parent_copy.placement, target_dist, level_wl, level_dist);
 				double target_object = cal_objective(target_area, target_dist, alpha, beta);
-				if (parent_copy.rects.empty()) { update_objective(target_object, target_area, target_wirelength, parent_copy.dst); }
+				if (parent_copy.rects.empty()) {
+					update_objective(target_object, target_area, target_wirelength, parent_copy.placement);
+					archive(target_area, target_dist, target_wirelength, parent_copy.placement);
+				}
 				if (is_lookahead) { child.lookahead_eval = target_object; }
 				else { child.global_eval = target_object; }
 			}
-		}
-
-		/// ֲ & rect_xcoord
-		bool score_area_and_set_xcoord(const BeamNode& parent, int width, int height, int& x, int& score) {
-			if (width > parent.skyline[parent.bl_index].width) { return false; }
-
-			SkylineSpace space = skyline_nodo_to_space(parent.skyline, parent.bl_index);
-			if (space.hl >= space.hr) {
-				if (width == space.width && height == space.hl) { score = 7; }
-				else if (width == space.width && height == space.hr) { score = 6; }
-				else if (width == space.width && height > space.hl) { score = 5; }
-				else if (width < space.width && height == space.hl) { score = 4; }
-				else if (width == space.width && height < space.hl && height > space.hr) { score = 3; }
-				else if (width < space.width && height == space.hr) { score = 2; } // 
-				else if (width == space.width && height < space.hr) { score = 1; }
-				else if (width < space.width && height != space.hl) { score = 0; }
-				else { return false; }
-
-				if (score == 2) { x = parent.skyline[parent.bl_index].x + parent.skyline[parent.bl_index].width - width; }
-				else { x = parent.skyline[parent.bl_index].x; }
-			}
-			else { // hl < hr
-				if (width == space.width && height == space.hr) { score = 7; }
-				else if (width == space.width && height == space.hl) { score = 6; }
-				else if (width == space.width && height > space.hr) { score = 5; }
-				else if (width < space.width && height == space.hr) { score = 4; } // 
-				else if (width == space.width && height < space.hr && height > space.hl) { score = 3; }
-				else if (width < space.width && height == space.hl) { score = 2; }
-				else if (width == space.width && height < space.hl) { score = 1; }
-				else if (width < space.width && height != space.hr) { score = 0; } // 
-				else { return false; }
-
-				if (score == 4 || score == 0) { x = parent.skyline[parent.bl_index].x + parent.skyline[parent.bl_index].width - width; }
-				else { x = parent.skyline[parent.bl_index].x; }
-			}
-			if (x + width > _bin_width) { return false; }
-
 			return true;
 		}
 
-		/// ֲ߳ԣƽ߳
+		/// ֲ߳ԣƽ߳ϵۼ
 		double score_wire(const BranchNode& node) {
-			double pin_x = node.chosen_rect_xcoord + node.chosen_rect_width * 0.5;
-			double pin_y = node.parent->skyline[node.parent->bl_index].y + node.chosen_rect_height * 0.5;
+			int pin_x = 2 * node.chosen_rect_xcoord + node.chosen_rect_width;
+			int pin_y = 2 * node.parent->skyline[node.parent->bl_index].y + node.chosen_rect_height;
 
 			int wire_num = 0;
-			double wire_length = 0;
+			long long wire_length2 = 0;
+			const Placement& placement = node.parent->placement;
 			for (int i = 0; i < _graph.size(); ++i) {
-				if (_graph[i][node.chosen_rect_index] && node.parent->is_packed[i]) {
+				if (_graph[i][node.chosen_rect_index] && placement.is_packed(i)) {
 					wire_num += _graph[i][node.chosen_rect_index];
-					wire_length += _graph[i][node.chosen_rect_index] * utils::cal_distance(
-						utils::LevelDist::ManhattanDist, pin_x, pin_y,
-						node.parent->dst[i].x + node.parent->dst[i].width * 0.5,
-						node.parent->dst[i].y + node.parent->dst[i].height * 0.5);
+					wire_length2 += _graph[i][node.chosen_rect_index] * (
+						static_cast<long long>(abs(pin_x - 2 * placement.x[i] - placed_width(placement, i)))
+						+ abs(pin_y - 2 * placement.y[i] - placed_height(placement, i)));
 				}
 			}
 
-			return  wire_num ? wire_length / wire_num : INF; // ѷõĿûйȼ(INF)
+			return  wire_num ? wire_length2 / 2.0 / wire_num : INF; // ѷõĿûйȼ(INF)
 		}
 
 		/// ڵǰֲĻϣ̰Ĺһ/ֲ
 		int greedy_construction(BeamNode& parent, bool is_lookahead) {
+			profile_scope(GreedyConstruction);
 			int max_skyline_height = max_element(parent.skyline.begin(), parent.skyline.end(), [](auto& lhs, auto& rhs) {
 				return lhs.y < rhs.y; })->y;
 			int lookahead_stop_height = max_skyline_height;
@@ -305,6 +418,7 @@ namespace fbp {
 				find_rect_for_parent(parent, rect_index, rect_width, rect_height, rect_xcoord);
 				max_skyline_height = max(max_skyline_height,
 					insert_chosen_rect_for_parent(parent, rect_index, rect_width, rect_height, rect_xcoord));
+				if (max_skyline_height > _bin_height) { break; } // ߶Ͻ磬֦
 			}
 
 			return max_skyline_height;
@@ -312,79 +426,21 @@ namespace fbp {
 
 		/// Ϊǰ̰ѡһ
 		void find_rect_for_parent(const BeamNode& parent, int& rect_index, int& rect_width, int& rect_height, int& rect_xcoord) {
-			int best_score = -1;
-			for (int r : parent.rects) {
-				int width = _src.at(r).width, height = _src.at(r).height;
-				int xcoord, score;
-				for (int rotate = 0; rotate <= 1; ++rotate) {
-					if (rotate) { swap(width, height); }
-					if (score_area_and_set_xcoord(parent, width, height, xcoord, score)) {
-						if (best_score < score) {
-							best_score = score;
-							rect_index = r;
-							rect_width = width;
-							rect_height = height;
-							rect_xcoord = xcoord;
-						}
-					}
-				}
-			}
-			// (d)(f)(h)˻
-			if ((best_score == 4 || best_score == 2 || best_score == 0) && parent.rects.size() > 1) {
-				int min_unpacked_width = numeric_limits<int>::max();
-				for (int r : parent.rects) {
-					if (r == rect_index) { continue; }
-					min_unpacked_width = min(min_unpacked_width, _src.at(r).width);
-				}
-				// δõСȷŲ£˷
-				if (min_unpacked_width > parent.skyline[parent.bl_index].width - rect_width) {
-					SkylineSpace space = skyline_nodo_to_space(parent.skyline, parent.bl_index);
-					int min_space_height = min(space.hl, space.hr);
-					int new_best_rect = -1;
-					int new_best_width = 0, new_best_height;
-					for (int r : parent.rects) {
-						for (int rotate = 0; rotate <= 1; ++rotate) {
-							int width = _src.at(r).width, height = _src.at(r).height;
-							if (rotate) { swap(width, height); }
-							if (height >= min_space_height // ߲Сmin_space_height
-								&& width <= space.width // ܷ
-								&& width > new_best_width) { // 
-								new_best_rect = r;
-								new_best_width = width;
-								new_best_height = height;
-							}
-						}
-					}
-					if (new_best_rect != -1) {
-						rect_index = new_best_rect;
-						rect_width = new_best_width;
-						rect_height = new_best_height;
-						rect_xcoord = space.hl >= space.hr ? // 뿿ߵһ
-							parent.skyline[parent.bl_index].x : // 
-							parent.skyline[parent.bl_index].x + parent.skyline[parent.bl_index].width - new_best_width; // 
-					}
-				}
-			}
+			rect_index = find_rect_for_space(skyline_nodo_to_space(parent.skyline, parent.bl_index), parent.rects,
+				rect_width, rect_height, rect_xcoord);
 		}
 
 		/// ִѡеĶparent
 		int insert_chosen_rect_for_parent(BeamNode& parent, int rect_index, int rect_width, int rect_height, int rect_xcoord) {
+			profile_count(InsertChosenRect);
 			// ִз
-			parent.dst[rect_index].x = rect_xcoord;
-			parent.dst[rect_index].y = parent.skyline[parent.bl_index].y;
-			parent.dst[rect_index].width = rect_width;
-			parent.dst[rect_index].height = rect_height;
+			parent.placement.place(rect_index, rect_xcoord, parent.skyline[parent.bl_index].y, rect_width != _widths[rect_index]);
 
 			// δбɾ
-			parent.rects.remove(rect_index);
-			parent.is_packed[rect_index] = true;
+			parent.rects.erase(find(parent.rects.begin(), parent.rects.end(), rect_index));
 
 			// skyline
-			SkylineNode new_skyline_node{
-				parent.dst[rect_index].x,
-				parent.dst[rect_index].y + parent.dst[rect_index].height,
-				parent.dst[rect_index].width
-			};
+			SkylineNode new_skyline_node{ rect_xcoord, parent.placement.y[rect_index] + rect_height, rect_width };
 			if (new_skyline_node.x == parent.skyline[parent.bl_index].x) { // 
 				parent.skyline.insert(parent.skyline.begin() + parent.bl_index, new_skyline_node);
 				parent.skyline[parent.bl_index + 1].x += new_skyline_node.width;
@@ -397,24 +453,31 @@ namespace fbp {
 				merge_skylines(parent.skyline);
 			}
 
-			// netwire
-			double pin_x = parent.dst[rect_index].x + parent.dst[rect_index].width * 0.5;
-			double pin_y = parent.dst[rect_index].y + parent.dst[rect_index].height * 0.5;
+			update_netwire(parent, rect_index);
+
+			return new_skyline_node.y;
+		}
+
+		/// ѷÿ`rect_index`żİΧ
+		void update_netwire(BeamNode& parent, int rect_index) {
+			int pin_x = 2 * parent.placement.x[rect_index] + placed_width(parent.placement, rect_index);
+			int pin_y = 2 * parent.placement.y[rect_index] + placed_height(parent.placement, rect_index);
 			for (int nid : _ins.get_blocks().at(rect_index).net_ids) {
 				NetwireNode& netwire_node = parent.netwire[nid];
 				netwire_node.max_x = max(netwire_node.max_x, pin_x);
 				netwire_node.min_x = min(netwire_node.min_x, pin_x);
 				netwire_node.max_y = max(netwire_node.max_y, pin_y);
 				netwire_node.min_y = min(netwire_node.min_y, pin_y);
-				netwire_node.hpwl = max(0.0, netwire_node.max_x - netwire_node.min_x + netwire_node.max_y - netwire_node.min_y);
+				netwire_node.hpwl = max(0LL, static_cast<long long>(netwire_node.max_x) - netwire_node.min_x + netwire_node.max_y - netwire_node.min_y);
 			}
-
-			return new_skyline_node.y;
 		}
 
 	private:
 		vector<BeamNode> _beam_tree;
 		bernoulli_distribution _bernoulli_dist;
+		int _run_beam_width; // ϵ״̬ռõ
+		int _run_count; // ѿʼִΣÿ
+		LevelMemory _level_peak;
 	};
 
 }
@@ -0,0 +1,275 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <new>
+
+#include "BeamSearcher.hpp"
+#include "RandomLocalSearcher.hpp"
+#include "InstanceGenerator.hpp"
+
+
+/// 全局分配计数：计时区间内的operator new调用次数及字节数
+/// 替换完整的一组分配函数(标量、数组及nothrow形式)，使每个new都与同族的delete配对
+static atomic<long long> alloc_num(0), alloc_bytes(0);
+
+static void* counted_malloc(size_t size) noexcept {
+	++alloc_num;
+	alloc_bytes += size;
+	return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+	if (void* p = counted_malloc(size)) { return p; }
+	throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+	if (void* p = counted_malloc(size)) { return p; }
+	throw bad_alloc();
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept { return counted_malloc(size); }
+
+void* operator new[](size_t size, const nothrow_t&) noexcept { return counted_malloc(size); }
+
+// GCC内联后把这里的free与容器中经::operator new得到的指针配对，不识别这是被替换的一组函数，误报-Wmismatched-new-delete
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete[](void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+void operator delete(void* p, const nothrow_t&) noexcept { free(p); }
+
+void operator delete[](void* p, const nothrow_t&) noexcept { free(p); }
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+
+namespace fbp {
+
+	/// 打包与评估热点的微基准：每个核函数在打包到一半的现场上反复执行，报告ns/op和allocs/op
+	/// 现场由高度上界截断的一次完整打包得到，与搜索中实际遇到的skyline形态一致
+	class MicroBenchmark {
+	public:
+		MicroBenchmark(const Instance& ins, double min_time) :
+			_ins(ins), _src(ins.get_rects()), _bin_width(ceil(sqrt(1.05 * ins.get_total_area()))), _min_time(min_time),
+			_rls(ins, _src, _bin_width, 1), _bs(ins, _src, _bin_width, 1) {}
+
+		void run(const string& filter) {
+			_filter = filter;
+			prepare_rls();
+			prepare_bs();
+			bench_skyline();
+			bench_rls();
+			bench_bs();
+			bench_wirelength();
+		}
+
+		struct Result {
+			string kernel;
+			long long ops;
+			double ns_per_op;
+			double allocs_per_op;
+			double bytes_per_op;
+		};
+
+		const vector<Result>& get_results() const { return _results; }
+
+	private:
+		/// 以`batch`次操作为一批反复计时，直到累计计时超过`_min_time`；`setup`在每批之前执行，不计时
+		void measure(const string& kernel, int batch, const function<void()>& setup, const function<void()>& run_batch) {
+			if (kernel.find(_filter) == string::npos) { return; }
+			long long ops = 0, allocs = 0, bytes = 0;
+			double elapsed = 0;
+			while (elapsed < _min_time || ops == 0) {
+				setup();
+				long long alloc_num_start = alloc_num, alloc_bytes_start = alloc_bytes;
+				auto start = chrono::steady_clock::now();
+				run_batch();
+				elapsed += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+				allocs += alloc_num - alloc_num_start;
+				bytes += alloc_bytes - alloc_bytes_start;
+				ops += batch;
+			}
+			_results.push_back({ kernel, ops, 1e9 * elapsed / ops, 1.0 * allocs / ops, 1.0 * bytes / ops });
+			fprintf(stdout, "  %-50s %12.1f ns/op %10.2f allocs/op %12.1f B/op %10lld ops\n",
+				kernel.c_str(), _results.back().ns_per_op, _results.back().allocs_per_op, _results.back().bytes_per_op, ops);
+		}
+
+		/// RLS现场：按面积递减序打包一次得到高度，再以一半高度为上界重打，截断时的_skyline和_rects即为现场
+		void prepare_rls() {
+			_sequence = _rls._sort_rules[1].sequence;
+			_rls._rects.assign(_sequence.begin(), _sequence.end());
+			_full_height = _rls.insert_bottom_left_score(_full_placement);
+			_rls.set_bin_height(_full_height / 2);
+			_rls._rects.assign(_sequence.begin(), _sequence.end());
+			_rls.insert_bottom_left_score(_rls_placement);
+			_rls.set_bin_height(INF);
+			_rls_skyline = _rls._skyline;
+			_rls_rects = _rls._rects;
+			_rls_index = distance(_rls_skyline.begin(), min_element(_rls_skyline.begin(), _rls_skyline.end(), [](auto& lhs, auto& rhs) {
+				return lhs.y < rhs.y; }));
+		}
+
+		/// BS现场：从根节点贪心补全到一半高度
+		void prepare_bs() {
+			_bs.reset_beam_tree();
+			_bs_node = _bs._beam_tree.front();
+			_bs.set_bin_height(_full_height / 2);
+			_bs.greedy_construction(_bs_node, false);
+			_bs.set_bin_height(INF);
+			_bs.check_parent(_bs_node);
+		}
+
+		void bench_skyline() {
+			// 每个节点拆成等高的两段，merge_skylines将其合并回去
+			Skyline split;
+			for (auto& node : _rls_skyline) {
+				split.push_back({ node.x, node.y, node.width / 2 });
+				split.push_back({ node.x + node.width / 2, node.y, node.width - node.width / 2 });
+			}
+			const int batch = 256;
+			vector<Skyline> skylines(batch);
+			measure("merge_skylines", batch, [&] { for (auto& skyline : skylines) { skyline = split; } },
+				[&] { for (auto& skyline : skylines) { FloorplanPacker::merge_skylines(skyline); } });
+
+			int rect_index, rect_width, rect_height, rect_xcoord;
+			_bs.find_rect_for_parent(_bs_node, rect_index, rect_width, rect_height, rect_xcoord);
+			vector<BeamSearcher::BeamNode> nodes(batch);
+			measure("skyline insert (insert_chosen_rect_for_parent)", batch, [&] { for (auto& node : nodes) { node = _bs_node; } },
+				[&] { for (auto& node : nodes) { _bs.insert_chosen_rect_for_parent(node, rect_index, rect_width, rect_height, rect_xcoord); } });
+		}
+
+		void bench_rls() {
+			_rls._skyline = _rls_skyline;
+			_rls._rects = _rls_rects;
+			volatile int sink = 0;
+			// 每次调用对全部未放置块的两种朝向打分，按单个朝向计ns/op
+			SkylineSpace space = FloorplanPacker::skyline_nodo_to_space(_rls_skyline, _rls_index);
+			vector<int> rects(_rls_rects.begin(), _rls_rects.end());
+			const int calls = 16;
+			measure("score_gap", calls * 2 * rects.size(), [] {}, [&] {
+				for (int i = 0; i < calls; ++i) {
+					_rls.score_gap(space, rects);
+					sink = sink + _rls._gap_fit.scores[0];
+				}
+			});
+			int w, h, x;
+			measure("find_rect_for_skyline_bottom_left", 1, [] {}, [&] { sink = sink + _rls.find_rect_for_skyline_bottom_left(_rls_index, w, h, x); });
+			Placement placement = _rls_placement;
+			measure("insert_bottom_left_score", 1, [&] { _rls._rects.assign(_sequence.begin(), _sequence.end()); },
+				[&] { sink = sink + _rls.insert_bottom_left_score(placement); });
+		}
+
+		void bench_bs() {
+			vector<BeamSearcher::BranchNode> children;
+			measure("BeamSearcher::branch", 1, [] {}, [&] { _bs.branch(_bs_node, Config::LevelObjDist::SqrManhattanDist, children); });
+			measure("local_evaluation", 1, [] {}, [&] { _bs.local_evaluation(children, 0.5, 0.5); });
+			const int batch = 8;
+			vector<BeamSearcher::BeamNode> nodes(batch);
+			measure("greedy_construction", batch, [&] { for (auto& node : nodes) { node = _bs_node; } },
+				[&] { for (auto& node : nodes) { _bs.greedy_construction(node, false); } });
+			measure("greedy_construction (lookahead)", batch, [&] { for (auto& node : nodes) { node = _bs_node; } },
+				[&] { for (auto& node : nodes) { _bs.greedy_construction(node, true); } });
+		}
+
+		/// 完整解上的线长评估，覆盖全部(LevelWireLength, LevelObjDist)组合
+		void bench_wirelength() {
+			const pair<Config::LevelWireLength, const char*> wls[] = {
+				{ Config::LevelWireLength::Block, "Block" }, { Config::LevelWireLength::BlockAndTerminal, "BlockAndTerminal" } };
+			const pair<Config::LevelObjDist, const char*> dists[] = {
+				{ Config::LevelObjDist::WireLengthDist, "WireLengthDist" },
+				{ Config::LevelObjDist::SqrEuclideanDist, "SqrEuclideanDist" },
+				{ Config::LevelObjDist::SqrManhattanDist, "SqrManhattanDist" } };
+			volatile double sink = 0;
+			for (auto& wl : wls) {
+				for (auto& dist : dists) {
+					measure(string("cal_wirelength ") + wl.second + "/" + dist.second, 1, [] {}, [&] {
+						double d;
+						sink = sink + _rls.cal_wirelength(_full_placement, d, wl.first, dist.first) + d;
+					});
+				}
+			}
+		}
+
+	private:
+		const Instance& _ins;
+		const vector<Rect> _src;
+		const int _bin_width;
+		const double _min_time;
+		string _filter;
+
+		RandomLocalSearcher _rls;
+		BeamSearcher _bs;
+
+		// 现场
+		vector<int> _sequence;
+		Placement _full_placement;
+		int _full_height;
+		Placement _rls_placement;
+		Skyline _rls_skyline;
+		list<int> _rls_rects;
+		int _rls_index;
+		BeamSearcher::BeamNode _bs_node;
+
+		vector<Result> _results;
+	};
+
+}
+
+
+int main(int argc, char** argv) {
+
+	// Benchmark [--min-time <秒>] [--filter <核函数名子串>] [<bench>/<算例名> | syn<块数> ...]
+	// 默认算例：MCNC/ami49、GSRC/n100、GSRC/n300及合成算例syn1000、syn3000；结果追加到Solution/Benchmark.csv
+	double min_time = 0.2;
+	string filter;
+	vector<pair<string, string>> ins_names;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg == "--min-time" && i + 1 < argc) { min_time = atof(argv[++i]); }
+		else if (arg == "--filter" && i + 1 < argc) { filter = argv[++i]; }
+		else if (arg.compare(0, 3, "syn") == 0) { ins_names.push_back({ "GSRC", arg }); }
+		else if (arg.find('/') != string::npos) { ins_names.push_back({ arg.substr(0, arg.find('/')), arg.substr(arg.find('/') + 1) }); }
+		else { fprintf(stderr, "unknown option: %s\n", arg.c_str()); return 1; }
+	}
+	if (ins_names.empty()) { ins_names = { { "MCNC", "ami49" }, { "GSRC", "n100" }, { "GSRC", "n300" }, { "GSRC", "syn1000" }, { "GSRC", "syn3000" } }; }
+
+	ofstream log_file("Solution/Benchmark.csv", ios::app);
+	log_file.seekp(0, ios::end);
+	if (log_file.tellp() <= 0) { log_file << "Date,Instance,Kernel,Ops,NsPerOp,AllocsPerOp,BytesPerOp" << endl; }
+	string date = utils::Date::to_long_str();
+	for (auto& ins_name : ins_names) {
+		Environment env(ins_name.first, "H", ins_name.second);
+		bool is_synthetic = ins_name.second.compare(0, 3, "syn") == 0;
+		InstanceGenerator::Param param;
+		if (is_synthetic) { param.block_num = atoi(ins_name.second.c_str() + 3); }
+		Instance ins = is_synthetic ? InstanceGenerator(param).make_instance(env) : Instance(env);
+		if (ins.get_block_num() < 2) { fprintf(stderr, "%s: skipped\n", ins_name.second.c_str()); continue; }
+
+		fprintf(stdout, "%s: %d blocks, %d nets\n", ins_name.second.c_str(), ins.get_block_num(), ins.get_net_num());
+		fbp::MicroBenchmark bench(ins, min_time);
+		bench.run(filter);
+		for (auto& res : bench.get_results()) {
+			log_file << date << "," << ins_name.second << "," << res.kernel << "," << res.ops << ","
+				<< res.ns_per_op << "," << res.allocs_per_op << "," << res.bytes_per_op << endl;
+		}
+	}
+	return 0;
+}
@@ -38,12 +38,37 @@ struct Config {
 	double alpha = 0.5, beta = 0.5;        // ߳Ȩ
 	double lb_scale = 0.8, ub_scale = 1.2; // ƺѡĿ
 
-	int ub_time = 3600; // ASAʱʱ
+	int ub_time = 3600; // ASAʱʱ()ǽʱ
+	long long ub_step = 0; // ܹԤ()>0ʱֹԸ(, ߳)ɸ
 	int ub_iter = 8192; // RLS or BS
 
+	double target_objective = 0; // Ŀ꺯ֵﵽֵֹͣ0ʾĿ
+	double target_ratio = 0;     // `obj_map`οֵһ(+¡߳)/(+)ﵽñֹͣ0ʾĿ
+	double lb_gap = 0.01;        // Ž½Բ಻ֵֹͣ
+
+	int island_num = 1;          // ģ͵ĲworkerĿ>1ʱڲͬѡRLS
+	int migration_interval = 64; // ÿÿжٴRLSǨһξӢУ0ʾǨ()
+
+	bool warm_start = false;     // ϴ.fp
+	bool eco = false;            // ز֣.ecoĶ嵥ֻ´ϴ.fpӰĲ
+	double eco_time = 0.5;       // زֵʱ()
+	bool pareto_archive = false; // ¼дķ֧(, )⼯.pareto.csv
+	bool fixed_outline = false; // ̶߿ģʽ߲߿򣬳߶ϽĴǰ֦
+
+	bool multilevel = false;      // ̣ml_top_sizeʱӹϵ۴أչ
+	int ml_cluster_size = 32;     // ÿһڵ
+	int ml_top_size = 128;        // ڵĿޣʣʱ
+	long long ml_cluster_step = 512; // ÿĹԤ()
+	int partition_num = 1;        // ģʽ>1ʱѿ黮Ϊɷݣݲضƴ
+	bool quiet = false;           // ⱨ棬ڶ̼ģʽ
+
+	double checkpoint_interval = 0; // ()0ʾ棻ģͲ
+	bool resume = false;            // Ӽ㲻ڻƥʱͷʼ
+	double trace_interval = 0;      // 켣зʴ()0ʾ켣
+
 	enum class LevelCandidateWidth {
-		CombRotate, // [deprecated] ϼת
-		CombShort,  // [deprecated] Ƕ̱ߵ
+		CombRotate, // ϼת
+		CombShort,  // Ƕ̱ߵ
 		Interval,   // ԼȾ໮ֿ
 		Sqrt        // ƽƳ
 	} level_asa_cw = LevelCandidateWidth::Interval;
@@ -51,6 +76,7 @@ struct Config {
 	enum class LevelFloorplanPacker {
 		RandomLocalSearch,
 		BeamSearch,
+		Portfolio // ÿѡͬʱRLSBSλʱĽ
 	} level_asa_fbp = LevelFloorplanPacker::BeamSearch;
 
 	enum class LevelWireLength {
@@ -64,12 +90,18 @@ struct Config {
 		SqrEuclideanDist, // ζ֮ŷʽƽĺ
 		SqrManhattanDist  // ζ֮ƽĺ
 	} level_fbp_dist = LevelObjDist::SqrManhattanDist;
+
+	enum class LevelIslandTopology {
+		Ring,    // ͸ڿ
+		Complete // ͸е
+	} level_asa_topology = LevelIslandTopology::Ring;
 } cfg;
 
 std::ostream& operator<<(std::ostream& os, const Config& cfg) {
 	switch (cfg.level_asa_fbp) {
 	case Config::LevelFloorplanPacker::RandomLocalSearch: os << "RandomLocalSearch,"; break;
 	case Config::LevelFloorplanPacker::BeamSearch: os << "BeamSearch,"; break;
+	case Config::LevelFloorplanPacker::Portfolio: os << "Portfolio,"; break;
 	default: break;
 	}
 
@@ -16,6 +16,30 @@ struct Rect {
 	int height;
 };
 
+/// ֽĽṹ(SoA)ֻ֣״̬λĳߴ簴ӹ״ȡ
+struct Placement {
+	enum Flag : unsigned char { Rotated = 1, Packed = 2 };
+
+	std::vector<int> x;
+	std::vector<int> y;
+	std::vector<unsigned char> flags;
+
+	void resize(size_t n) {
+		x.resize(n);
+		y.resize(n);
+		flags.resize(n);
+	}
+
+	bool is_rotated(int i) const { return flags[i] & Rotated; }
+	bool is_packed(int i) const { return flags[i] & Packed; }
+
+	void place(int i, int px, int py, bool is_rotated) {
+		x[i] = px;
+		y[i] = py;
+		flags[i] = Packed | (is_rotated ? Rotated : 0);
+	}
+};
+
 struct Block {
 	std::string name;
 	std::vector<int> net_ids;
@@ -59,13 +83,32 @@ struct SkylineSpace {
 	int hr;
 };
 
+/// һͬһSkylineSpaceĴ֣SoA֣2k2k+1ֱΪrects[k]ԭʼת
+struct GapFit {
+	std::vector<int> rects;
+	std::vector<int> widths;
+	std::vector<int> heights;
+	std::vector<int> xs;
+	std::vector<int> scores; // 0~7ԽԽã-1ʾŲ(Ч)
+	int size = 0; // ЧĿ鱣
+
+	void resize(size_t n) {
+		rects.resize(n);
+		widths.resize(2 * n);
+		heights.resize(2 * n);
+		xs.resize(2 * n);
+		scores.resize(2 * n);
+	}
+};
+
 /// half perimeter wire length of the net
+/// ΧУ(2x+wΪ)
 struct NetwireNode {
-	double min_x;
-	double min_y;
-	double max_x;
-	double max_y;
-	double hpwl;
+	int min_x;
+	int min_y;
+	int max_x;
+	int max_y;
+	long long hpwl;
 };
 
 using Netwire = std::vector<NetwireNode>;
@@ -4,11 +4,19 @@
 //
 #pragma once
 
+#include <climits>
 #include <list>
 #include <numeric>
 
 #include "Config.hpp"
 #include "Instance.hpp"
+#include "ParetoArchive.hpp"
+
+// x64SSE2x86SSE2ָ
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FBP_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace fbp {
 
@@ -16,14 +24,29 @@ namespace fbp {
 
 	class FloorplanPacker {
 
+		friend class MicroBenchmark; // ΢׼ֱӼʱڲ˺
+
 	public:
 		FloorplanPacker() = delete;
 
-		FloorplanPacker(const Instance& ins, const vector<Rect>& src, int bin_width, default_random_engine& gen) :
+		FloorplanPacker(const Instance& ins, const vector<Rect>& src, int bin_width, unsigned int seed) :
 			_ins(ins), _src(src), _bin_width(bin_width), _bin_height(INF),
 			_graph(ins.get_block_num(), vector<int>(ins.get_block_num(), 0)),
-			_gen(gen), _dst(), _objective(numeric_limits<double>::max()),
+			_seed(seed), _gen(seed), _deadline(nullptr), _step_budget(numeric_limits<long long>::max()), _is_pending(false), _archive(nullptr),
+			_is_fixed(src.size(), false), _free_rects(src.size()), _base_skyline{ { 0, 0, bin_width } },
+			_pin_xs(src.size()), _pin_ys(src.size()), _is_net_seen(ins.get_net_num(), false),
+			_pack_num(0), _prune_num(0),
+			_dst(), _objective(numeric_limits<double>::max()),
 			_obj_area(numeric_limits<int>::max()), _obj_wirelength(numeric_limits<double>::max()) {
+			iota(_free_rects.begin(), _free_rects.end(), 0);
+			_net_ids.reserve(ins.get_net_num());
+			_gap_fit.resize(src.size());
+			_widths.reserve(src.size()); _heights.reserve(src.size());
+			for (auto& rect : src) {
+				_widths.push_back(rect.width);
+				_heights.push_back(rect.height);
+			}
+			_base_placement = make_placement(src, _is_fixed);
 			for (auto& net : _ins.get_netlist()) {
 				for (int i = 0; i < net.block_list.size(); ++i) {
 					for (int j = i + 1; j < net.block_list.size(); ++j) {
@@ -46,67 +69,214 @@ namespace fbp {
 
 		int get_bin_height() const { return _bin_height; }
 
+		/// ߶Ͻ磬г֦ĬINF֦
 		void set_bin_height(int height) { _bin_height = height; }
 
-		virtual void run(int, double, double, Config::LevelWireLength, Config::LevelObjDist) = 0;
+		/// ÿύķ֧⼯nullptrʾ¼
+		void set_archive(ParetoArchive* archive) { _archive = archive; }
+
+		/// ĴĿг߶Ͻ类Ŀ
+		long long get_pack_num() const { return _pack_num; }
+
+		long long get_prune_num() const { return _prune_num; }
+
+		/// ֹʱ䵽ȡʱ`run`һ֮ǰռ
+		void set_deadline(const utils::Deadline* deadline) { _deadline = deadline; }
+
+		/// Ԥ㣬ÿ(RLSһδ/BSһȫ)1ľʱ`run`ռ
+		void set_step_budget(long long steps) { _step_budget = steps; }
+
+		/// ʣĹԤ
+		long long get_step_budget() const { return _step_budget; }
+
+		/// һ`run`ռδ
+		bool is_pending() const { return _is_pending; }
+
+		/// ز֣`is_fixed`Ŀ̶`dst`еλãڹ̶ϰ֮´
+		virtual void set_fixed(const vector<Rect>& dst, const vector<bool>& is_fixed) {
+			_is_fixed = is_fixed;
+			_free_rects.clear();
+			vector<int> xs = { 0, _bin_width };
+			_base_placement = make_placement(dst, is_fixed);
+			for (int i = 0; i < _src.size(); ++i) {
+				if (!is_fixed[i]) {
+					_base_placement.x[i] = _src[i].x;
+					_base_placement.y[i] = _src[i].y;
+					_base_placement.flags[i] = 0;
+					_free_rects.push_back(i);
+					continue;
+				}
+				xs.push_back(dst[i].x);
+				xs.push_back(dst[i].x + dst[i].width);
+			}
+			sort(xs.begin(), xs.end());
+			xs.erase(unique(xs.begin(), xs.end()), xs.end());
+			_base_skyline.clear();
+			for (int k = 0; k + 1 < xs.size() && xs[k] < _bin_width; ++k) {
+				int y = 0;
+				for (int i = 0; i < _src.size(); ++i) {
+					if (is_fixed[i] && dst[i].x < xs[k + 1] && dst[i].x + dst[i].width > xs[k]) { y = max(y, dst[i].y + dst[i].height); }
+				}
+				_base_skyline.push_back({ xs[k], y, min(xs[k + 1], _bin_width) - xs[k] });
+			}
+			merge_skylines(_base_skyline);
+		}
+
+		/// һ(ǨľӢл)ݴ˹⣻ɷtrue
+		virtual bool accept_sequence(const vector<int>&, double, double, Config::LevelWireLength, Config::LevelObjDist) = 0;
+
+		/// ֱ(ϷҿȲ_bin_width)ڵǰŽ
+		void warm_start(const vector<Rect>& dst, double alpha, double beta, Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			int height = 0;
+			for (auto& rect : dst) { height = max(height, rect.y + rect.height); }
+			Placement placement = make_placement(dst, vector<bool>(dst.size(), true));
+			double dist;
+			double wirelength = cal_wirelength(placement, dist, level_wl, level_dist);
+			int area = height * _bin_width;
+			update_objective(cal_objective(area, dist, alpha, beta), area, wirelength, placement);
+		}
+
+		/// 㣺лɻָ״ֻ̬`run`֮
+		virtual void save(ostream& os) const {
+			os << _bin_height << ' ' << _gen << ' ' << _objective << ' ' << _obj_area << ' ' << _obj_wirelength << ' ' << _dst.size();
+			for (auto& rect : _dst) { os << ' ' << rect.id << ' ' << rect.x << ' ' << rect.y << ' ' << rect.width << ' ' << rect.height; }
+			os << '\n';
+		}
+
+		virtual bool load(istream& is) {
+			size_t dst_size = 0;
+			is >> _bin_height >> ws >> _gen >> _objective >> _obj_area >> _obj_wirelength >> dst_size;
+			_dst.resize(is ? dst_size : 0);
+			for (auto& rect : _dst) { is >> rect.id >> rect.x >> rect.y >> rect.width >> rect.height; }
+			_is_pending = false;
+			return static_cast<bool>(is);
+		}
+
+		/// ڶϵֽ׷ӸԵĹ
+		virtual void account_memory(utils::MemoryUsage& usage) const {
+			long long graph = utils::heap_bytes(_graph);
+			for (auto& row : _graph) { graph += utils::heap_bytes(row); }
+			usage.resident["packer.graph"] += graph;
+			usage.resident["packer.dst"] += utils::heap_bytes(_dst)
+				+ utils::heap_bytes(_base_placement.x) + utils::heap_bytes(_base_placement.y) + utils::heap_bytes(_base_placement.flags);
+			usage.resident["packer.fixed"] += utils::heap_bytes(_is_fixed) + utils::heap_bytes(_free_rects) + utils::heap_bytes(_base_skyline);
+			usage.resident["packer.workspace"] += utils::heap_bytes(_widths) + utils::heap_bytes(_heights)
+				+ utils::heap_bytes(_pin_xs) + utils::heap_bytes(_pin_ys) + utils::heap_bytes(_net_ids) + utils::heap_bytes(_is_net_seen)
+				+ utils::heap_bytes(_gap_fit.rects) + utils::heap_bytes(_gap_fit.widths) + utils::heap_bytes(_gap_fit.heights)
+				+ utils::heap_bytes(_gap_fit.xs) + utils::heap_bytes(_gap_fit.scores);
+		}
+
+		/// trueʾɣfalseʾռٴε`run`Ӷϵ(ñռʱiter)
+		virtual bool run(int, double, double, Config::LevelWireLength, Config::LevelObjDist) = 0;
 
 	protected:
+		/// һԤ㣬falseʾӦռ
+		bool next_step() {
+			if (_step_budget <= 0 || (_deadline && _deadline->expired())) { return false; }
+			--_step_budget;
+			return true;
+		}
+
+		void archive(int area, double dist, double wirelength, const Placement& placement) {
+			if (!_archive || _archive->is_dominated(area, dist)) { return; }
+			vector<Rect> dst;
+			to_rects(placement, dst);
+			_archive->insert(area, dist, wirelength, _bin_width, dst);
+		}
+
+		/// ״ȡѷÿĳߴ
+		int placed_width(const Placement& placement, int i) const { return placement.is_rotated(i) ? _heights[i] : _widths[i]; }
+
+		int placed_height(const Placement& placement, int i) const { return placement.is_rotated(i) ? _widths[i] : _heights[i]; }
+
+		/// `dst`תΪSoA֣ԭʼߴ粻ͬĿΪת
+		Placement make_placement(const vector<Rect>& dst, const vector<bool>& is_packed) const {
+			Placement placement;
+			placement.resize(dst.size());
+			for (int i = 0; i < dst.size(); ++i) {
+				placement.x[i] = dst[i].x;
+				placement.y[i] = dst[i].y;
+				placement.flags[i] = (is_packed[i] ? Placement::Packed : 0) | (dst[i].width != _widths[i] ? Placement::Rotated : 0);
+			}
+			return placement;
+		}
+
+		/// SoAֻԭΪľΣֻŽʱ
+		void to_rects(const Placement& placement, vector<Rect>& dst) const {
+			dst.resize(placement.x.size());
+			for (int i = 0; i < dst.size(); ++i) {
+				dst[i] = { i, placement.x[i], placement.y[i], placed_width(placement, i), placed_height(placement, i) };
+			}
+		}
+
 		/// Ŀ꺯
 		double cal_objective(int area, double dist, double alpha, double beta) {
 			return alpha * area + beta * dist;
 		}
 
 		/// ߳Ĭ
-		double cal_wirelength(const vector<Rect>& dst, const vector<bool>& is_packed, double& dist,
-			Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
-			double total_wirelength = 0;
-			dist = 0;
+		double cal_wirelength(const Placement& placement, double& dist, Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			profile_count(CalWirelength);
+			// ϵм㣺2x+wΪ߳;64λۼӣȽϺƽжȷ޹
+			long long total_wirelength2 = 0;
+			long long dist4 = 0;
 
-			vector<pair<double, double>> pins(dst.size());
-			unordered_set<int> nets;
-			for (int i = 0; i < dst.size(); ++i) {
-				if (!is_packed[i]) { continue; } // ֻ㵱ǰѷõĿ
-				pins[i].first = dst[i].x + dst[i].width * 0.5;
-				pins[i].second = dst[i].y + dst[i].height * 0.5;
-				nets.insert(_ins.get_blocks().at(i).net_ids.begin(), _ins.get_blocks().at(i).net_ids.end());
+			// ģѡȡߴ磬޷֧ѭɱδÿŲᱻȡ
+			int rect_num = placement.x.size();
+			const unsigned char* flags = placement.flags.data();
+			for (int i = 0; i < rect_num; ++i) {
+				bool is_rotated = flags[i] & Placement::Rotated;
+				_pin_xs[i] = 2 * placement.x[i] + (is_rotated ? _heights[i] : _widths[i]);
+				_pin_ys[i] = 2 * placement.y[i] + (is_rotated ? _widths[i] : _heights[i]);
 			}
-			assert(!nets.empty());
+			// óԱÿڶϷ䣻״γֵ˳ۼ
+			_net_ids.clear();
+			for (int i = 0; i < rect_num; ++i) {
+				if (!placement.is_packed(i)) { continue; } // ֻ㵱ǰѷõĿ
+				for (int nid : _ins.get_blocks().at(i).net_ids) {
+					if (!_is_net_seen[nid]) {
+						_is_net_seen[nid] = true;
+						_net_ids.push_back(nid);
+					}
+				}
+			}
+			for (int nid : _net_ids) { _is_net_seen[nid] = false; }
 
-			for (int nid : nets) {
-				double max_x = 0, min_x = numeric_limits<double>::max();
-				double max_y = 0, min_y = numeric_limits<double>::max();
+			for (int nid : _net_ids) {
+				int max_x = INT_MIN, min_x = INT_MAX; // terminalΪ(ľֲϵ)
+				int max_y = INT_MIN, min_y = INT_MAX;
 				for (int bid : _ins.get_netlist().at(nid).block_list) {
-					if (!is_packed[bid]) { continue; }
-					max_x = max(max_x, pins[bid].first);
-					min_x = min(min_x, pins[bid].first);
-					max_y = max(max_y, pins[bid].second);
-					min_y = min(min_y, pins[bid].second);
+					if (!placement.is_packed(bid)) { continue; }
+					max_x = max(max_x, _pin_xs[bid]);
+					min_x = min(min_x, _pin_xs[bid]);
+					max_y = max(max_y, _pin_ys[bid]);
+					min_y = min(min_y, _pin_ys[bid]);
 				}
 				if (level_wl == Config::LevelWireLength::BlockAndTerminal) {
 					for (int tid : _ins.get_netlist().at(nid).terminal_list) {
-						double pad_x = _ins.get_terminals().at(tid).x_coordinate;
-						double pad_y = _ins.get_terminals().at(tid).y_coordinate;
+						int pad_x = 2 * _ins.get_terminals().at(tid).x_coordinate;
+						int pad_y = 2 * _ins.get_terminals().at(tid).y_coordinate;
 						max_x = max(max_x, pad_x);
 						min_x = min(min_x, pad_x);
 						max_y = max(max_y, pad_y);
 						min_y = min(min_y, pad_y);
 					}
 				}
-				double hpwl = max_x - min_x + max_y - min_y;
-				total_wirelength += hpwl;
+				total_wirelength2 += static_cast<long long>(max_x) - min_x + max_y - min_y;
 			}
+			double total_wirelength = total_wirelength2 / 2.0;
 
 			switch (level_dist) {
 			case Config::LevelObjDist::WireLengthDist:
-				dist = total_wirelength; //  ߳
+				dist4 = 2 * total_wirelength2; //  ߳
 				break;
 			case Config::LevelObjDist::SqrEuclideanDist:
 				for (int i = 0; i < _graph.size(); ++i) {
 					for (int j = i + 1; j < _graph.size(); ++j) {
-						if (is_packed[i] && is_packed[j] && _graph[i][j]) {
-							double dx = pins[i].first - pins[j].first;
-							double dy = pins[i].second - pins[j].second;
-							dist += dx * dx + dy * dy; //  ֮ŷƽ룺dx^2+dy^2
+						if (placement.is_packed(i) && placement.is_packed(j) && _graph[i][j]) {
+							long long dx = _pin_xs[i] - _pin_xs[j];
+							long long dy = _pin_ys[i] - _pin_ys[j];
+							dist4 += dx * dx + dy * dy; //  ֮ŷƽ룺dx^2+dy^2
 						}
 					}
 				}
@@ -114,10 +284,10 @@ namespace fbp {
 			case Config::LevelObjDist::SqrManhattanDist:
 				for (int i = 0; i < _graph.size(); ++i) {
 					for (int j = i + 1; j < _graph.size(); ++j) {
-						if (is_packed[i] && is_packed[j] && _graph[i][j]) {
-							double dx = abs(pins[i].first - pins[j].first);
-							double dy = abs(pins[i].second - pins[j].second);
-							dist += (dx + dy) * (dx + dy); //  ֮ƽ룺(dx+dy)^2
+						if (placement.is_packed(i) && placement.is_packed(j) && _graph[i][j]) {
+							long long dx = abs(_pin_xs[i] - _pin_xs[j]);
+							long long dy = abs(_pin_ys[i] - _pin_ys[j]);
+							dist4 += (dx + dy) * (dx + dy); //  ֮ƽ룺(dx+dy)^2
 						}
 					}
 				}
@@ -126,16 +296,17 @@ namespace fbp {
 				break;
 			}
 
+			dist = dist4 / 4.0;
 			return total_wirelength;
 		}
 
 		/// Ž
-		void update_objective(double objective, int area, double wirelength, const vector<Rect>& dst) {
-			if (_objective > objective + numeric_limits<double>::epsilon()) {
+		void update_objective(double objective, int area, double wirelength, const Placement& placement) {
+			if (objective < _objective) {
 				_objective = objective;
 				_obj_area = area;
 				_obj_wirelength = wirelength;
-				_dst = dst;
+				to_rects(placement, _dst);
 			}
 		}
 
@@ -160,6 +331,129 @@ namespace fbp {
 			return { skyline[skyline_index].x, skyline[skyline_index].y, skyline[skyline_index].width, hl, hr };
 		}
 
+		/// δÿֳԿλ`space`һԴ֣д`_gap_fit`Ȱռߴ磬`classify_gap`
+		template<typename Rects>
+		void score_gap(const SkylineSpace& space, const Rects& rects) {
+			GapFit& fit = _gap_fit;
+			fit.size = 0;
+			for (int r : rects) {
+				int k = fit.size++;
+				fit.rects[k] = r;
+				fit.widths[2 * k] = fit.heights[2 * k + 1] = _widths[r];
+				fit.heights[2 * k] = fit.widths[2 * k + 1] = _heights[r];
+			}
+			classify_gap(space, fit);
+		}
+
+		/// ÷򰴽ϸһԳƣ(a)7 ߶ (b)6 ϡͲ (c)5 ϡ߲߳
+		/// (d)4 ߲ࡢ߲ (e)3 ϡ߽֮ (f)2 ͲࡢͲ (g)1 ϡڵͲ (h)0 ࡢ߲
+		/// ֻȽϺͰѡûз֧SSE2ÿδ4µļƽ̨
+		void classify_gap(const SkylineSpace& space, GapFit& fit) const {
+			int space_x = space.x, space_width = space.width, bin_width = _bin_width;
+			int high = max(space.hl, space.hr), low = min(space.hl, space.hr);
+			int is_low_right = space.hl >= space.hr;
+			int n = 2 * fit.size;
+			const int* widths = fit.widths.data();
+			const int* heights = fit.heights.data();
+			int* xs = fit.xs.data();
+			int* scores = fit.scores.data();
+			int k = 0;
+#ifdef FBP_SSE2
+			// ȽϽΪȫ1/ȫ0룬select(m, a, b) = (m & a) | (~m & b)
+			auto select = [](__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); };
+			const __m128i v_high = _mm_set1_epi32(high), v_low = _mm_set1_epi32(low);
+			const __m128i v_space_x = _mm_set1_epi32(space_x), v_space_width = _mm_set1_epi32(space_width), v_bin_width = _mm_set1_epi32(bin_width);
+			const __m128i v_is_high_right = _mm_set1_epi32(is_low_right ? 0 : -1);
+			const __m128i v_one = _mm_set1_epi32(1), v_two = _mm_set1_epi32(2), v_four = _mm_set1_epi32(4);
+			const __m128i v_six = _mm_set1_epi32(6), v_seven = _mm_set1_epi32(7), v_none = _mm_set1_epi32(-1);
+			for (; k + 4 <= n; k += 4) {
+				__m128i width = _mm_loadu_si128(reinterpret_cast<const __m128i*>(widths + k));
+				__m128i height = _mm_loadu_si128(reinterpret_cast<const __m128i*>(heights + k));
+				__m128i is_eq_high = _mm_cmpeq_epi32(height, v_high), is_eq_low = _mm_cmpeq_epi32(height, v_low);
+				__m128i is_gt_high = _mm_cmpgt_epi32(height, v_high), is_gt_low = _mm_cmpgt_epi32(height, v_low);
+				__m128i is_full = _mm_cmpeq_epi32(width, v_space_width);
+				// ϣ1/3/5(-1)õθ67
+				__m128i full_score = _mm_sub_epi32(v_one, _mm_add_epi32(_mm_add_epi32(is_gt_low, is_gt_low), _mm_add_epi32(is_gt_high, is_gt_high)));
+				full_score = select(is_eq_high, v_seven, select(is_eq_low, v_six, full_score));
+				__m128i part_score = select(is_eq_high, v_four, _mm_and_si128(is_eq_low, v_two));
+				__m128i score = select(is_full, full_score, part_score);
+				// (f)Ͳ࣬(d)(h)߲ࣻʱx
+				__m128i is_f = _mm_andnot_si128(is_eq_high, is_eq_low);
+				__m128i is_right = _mm_andnot_si128(is_full, _mm_xor_si128(is_f, v_is_high_right));
+				__m128i x = _mm_add_epi32(v_space_x, _mm_and_si128(is_right, _mm_sub_epi32(v_space_width, width)));
+				__m128i is_over = _mm_or_si128(_mm_cmpgt_epi32(width, v_space_width), _mm_cmpgt_epi32(_mm_add_epi32(x, width), v_bin_width));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(xs + k), x);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(scores + k), select(is_over, v_none, score));
+			}
+#endif
+			for (; k < n; ++k) {
+				int width = widths[k], height = heights[k];
+				int full_score = height > high ? 5 : height > low ? 3 : 1; // 
+				full_score = height == low ? 6 : full_score;
+				full_score = height == high ? 7 : full_score;
+				int part_score = height == low ? 2 : 0; // ʣ
+				part_score = height == high ? 4 : part_score;
+				int score = width == space_width ? full_score : part_score;
+				int is_right = part_score == 2 ? is_low_right : 1 - is_low_right;
+				is_right = width < space_width ? is_right : 0;
+				int x = space_x + is_right * (space_width - width);
+				int overflow = max(width - space_width, x + width - bin_width); // 0ʾŲ
+				xs[k] = x;
+				scores[k] = overflow > 0 ? -1 : score;
+			}
+		}
+
+		/// ڴֲΪλѡһ飬ͬȡȳߣؿżúĿߺx꣬ûзŵµĿʱ-1ҿߺx0
+		template<typename Rects>
+		int find_rect_for_space(const SkylineSpace& space, const Rects& rects, int& rect_width, int& rect_height, int& rect_xcoord) {
+			score_gap(space, rects);
+			const GapFit& fit = _gap_fit;
+			// ߷(ĹԼ)ȡһﵽ߷ֵĳ
+			int n = 2 * fit.size;
+			const int* scores = fit.scores.data();
+			int best_score = -1;
+			for (int k = 0; k < n; ++k) { best_score = max(best_score, scores[k]); }
+			if (best_score < 0) {
+				rect_width = rect_height = rect_xcoord = 0;
+				return -1;
+			}
+			int best = find(scores, scores + n, best_score) - scores;
+			rect_width = fit.widths[best];
+			rect_height = fit.heights[best];
+			rect_xcoord = fit.xs[best];
+
+			// (d)(f)(h)˻
+			if ((best_score == 4 || best_score == 2 || best_score == 0) && fit.size > 1) {
+				int min_unpacked_width = numeric_limits<int>::max();
+				for (int k = 0; k < fit.size; ++k) {
+					if (k == best / 2) { continue; }
+					min_unpacked_width = min(min_unpacked_width, fit.widths[2 * k]);
+				}
+				// δõСȷŲ£˷
+				if (min_unpacked_width > space.width - rect_width) {
+					int min_space_height = min(space.hl, space.hr);
+					int new_best = -1, new_best_width = 0;
+					for (int k = 0; k < 2 * fit.size; ++k) {
+						if (fit.heights[k] >= min_space_height // ߲Сmin_space_height
+							&& fit.widths[k] <= space.width // ܷ
+							&& fit.widths[k] > new_best_width) { // 
+							new_best = k;
+							new_best_width = fit.widths[k];
+						}
+					}
+					if (new_best != -1) {
+						best = new_best;
+						rect_width = new_best_width;
+						rect_height = fit.heights[new_best];
+						rect_xcoord = space.hl >= space.hr ? // 뿿ߵһ
+							space.x : // 
+							space.x + space.width - new_best_width; // 
+					}
+				}
+			}
+			return fit.rects[best / 2];
+		}
+
 		/// ϲͬһlevelskylineڵ.
 		static void merge_skylines(Skyline& skyline) {
 			skyline.erase(
@@ -179,10 +473,39 @@ namespace fbp {
 		// 
 		const Instance& _ins;
 		const vector<Rect>& _src;
+		vector<int> _widths; // ״ŵԭʼߴ磬ֻ
+		vector<int> _heights;
 		const int _bin_width;
 		int _bin_height; // const_bin_heightǰ֦
 		vector<vector<int>> _graph; // net_listԭͼ֮ӵĽ̶ܳ
-		default_random_engine& _gen;
+		const unsigned int _seed; // ޹
+		default_random_engine _gen;
+
+		// ռ
+		const utils::Deadline* _deadline;
+		long long _step_budget;
+		bool _is_pending;
+
+		ParetoArchive* _archive;
+
+		// زֵ㣺̶ѷãĬΪղ
+		Placement _base_placement;
+		vector<bool> _is_fixed;
+		vector<int> _free_rects; // Ŀ
+		Skyline _base_skyline; // ̶ϰ
+
+		// score_gapĹ
+		GapFit _gap_fit;
+
+		// cal_wirelengthĹ
+		vector<int> _pin_xs; // 
+		vector<int> _pin_ys;
+		vector<int> _net_ids;
+		vector<bool> _is_net_seen;
+
+		// ߶Ͻ֦ͳ
+		long long _pack_num;
+		long long _prune_num;
 
 		// ŻĿ
 		vector<Rect> _dst;
@@ -0,0 +1,45 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#include "InstanceGenerator.hpp"
+
+
+int main(int argc, char** argv) {
+
+	// Generator <算例名> [选项]：在Instance/GSRC/HARD/下生成<算例名>.blocks/.nets/.pl
+	// --blocks <块数> --terminals <terminal数> --area-mean <平均面积> --area-sigma <对数标准差>
+	// --aspect <最大长宽比> --net-ratio <线网数/块数> --degree-mean <平均度数> --degree-max <最大度数>
+	// --rent <Rent指数> --seed <随机种子> --bench <GSRC|MCNC>
+	if (argc < 2 || argv[1][0] == '-') {
+		fprintf(stderr, "usage: %s <name> [--blocks n] [--terminals n] [--area-mean a] [--area-sigma s] [--aspect r]"
+			" [--net-ratio k] [--degree-mean d] [--degree-max d] [--rent p] [--seed s] [--bench GSRC|MCNC]\n", argv[0]);
+		return 1;
+	}
+	string name = argv[1], bench = "GSRC";
+	InstanceGenerator::Param param;
+	for (int i = 2; i < argc; ++i) {
+		string arg = argv[i];
+		if (i + 1 >= argc) { fprintf(stderr, "missing value: %s\n", arg.c_str()); return 1; }
+		if (arg == "--blocks") { param.block_num = atoi(argv[++i]); }
+		else if (arg == "--terminals") { param.terminal_num = atoi(argv[++i]); }
+		else if (arg == "--area-mean") { param.area_mean = atof(argv[++i]); }
+		else if (arg == "--area-sigma") { param.area_sigma = atof(argv[++i]); }
+		else if (arg == "--aspect") { param.max_aspect_ratio = atof(argv[++i]); }
+		else if (arg == "--net-ratio") { param.net_ratio = atof(argv[++i]); }
+		else if (arg == "--degree-mean") { param.degree_mean = atof(argv[++i]); }
+		else if (arg == "--degree-max") { param.max_degree = atoi(argv[++i]); }
+		else if (arg == "--rent") { param.rent_exponent = atof(argv[++i]); }
+		else if (arg == "--seed") { param.seed = static_cast<unsigned int>(atoll(argv[++i])); }
+		else if (arg == "--bench") { bench = argv[++i]; }
+		else { fprintf(stderr, "unknown option: %s\n", arg.c_str()); return 1; }
+	}
+	if (param.block_num < 2 || param.block_num > 1000000) { fprintf(stderr, "block number must be in [2, 1000000]\n"); return 1; }
+
+	Environment env(bench, "H", name);
+	InstanceGenerator generator(param);
+	if (!generator.generate(env)) { return 1; }
+	fprintf(stdout, "%s: %d blocks, %d terminals written to %s.\n",
+		name.c_str(), param.block_num, param.terminal_num < 0 ? static_cast<int>(4 * sqrt(param.block_num)) : param.terminal_num, env.blocks_path().c_str());
+	return 0;
+}
@@ -0,0 +1,309 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#include <map>
+
+#include "AdaptiveSelecter.hpp"
+
+
+namespace harness {
+
+	/// 一次运行(算例, 种子)的质量-时间曲线：各检查点时刻的最优目标函数值，尚无解为inf
+	struct Run {
+		string ins_name;
+		unsigned int seed;
+		vector<double> curve;
+		double final_objective;
+		double time_to_target; // 首次达到目标比例的时间，未达到为inf
+	};
+
+	static constexpr double inf = numeric_limits<double>::infinity();
+
+	/// 中位数及其95%置信区间：按二项分布取次序统计量(正态近似)，样本过少时区间退化为最小、最大值
+	struct MedianCI {
+		double median, low, high;
+	};
+
+	static MedianCI median_ci(vector<double> values) {
+		if (values.empty()) { return { inf, inf, inf }; }
+		sort(values.begin(), values.end());
+		int n = values.size();
+		double median = n % 2 ? values[n / 2] : (values[n / 2 - 1] == values[n / 2] ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2);
+		double half_width = 1.96 * sqrt(n) / 2;
+		int low = max(0, static_cast<int>(floor(n / 2.0 - half_width)));
+		int high = min(n - 1, static_cast<int>(ceil(n / 2.0 + half_width)) - 1);
+		return { median, values[low], values[high] };
+	}
+
+	/// Mann-Whitney U检验的双侧p值，正态近似并校正结
+	static double mann_whitney_p(const vector<double>& a, const vector<double>& b) {
+		int n1 = a.size(), n2 = b.size(), n = n1 + n2;
+		if (n1 == 0 || n2 == 0) { return 1; }
+		vector<pair<double, int>> all;
+		for (double v : a) { all.push_back({ v, 0 }); }
+		for (double v : b) { all.push_back({ v, 1 }); }
+		sort(all.begin(), all.end());
+		double rank_sum = 0, tie_term = 0;
+		for (int i = 0, j; i < n; i = j) {
+			for (j = i; j < n && all[j].first == all[i].first; ++j) {}
+			double rank = (i + j + 1) / 2.0; // 结取平均秩
+			for (int k = i; k < j; ++k) { if (all[k].second == 0) { rank_sum += rank; } }
+			tie_term += pow(j - i, 3) - (j - i);
+		}
+		double u = rank_sum - n1 * (n1 + 1) / 2.0;
+		double sigma = sqrt(n1 * n2 / 12.0 * ((n + 1) - tie_term / (1.0 * n * (n - 1))));
+		if (sigma == 0) { return 1; }
+		double z = (abs(u - n1 * n2 / 2.0) - 0.5) / sigma; // 连续性校正
+		return min(1.0, erfc(max(0.0, z) / sqrt(2.0)));
+	}
+
+	/// 默认检查点：0.1s起按1-2-5递增，最后一个为时间上限
+	static vector<double> default_checkpoints(int ub_time) {
+		vector<double> checkpoints;
+		for (double decade = 0.1; decade < ub_time; decade *= 10) {
+			for (double step : { 1, 2, 5 }) {
+				if (decade * step < ub_time) { checkpoints.push_back(decade * step); }
+			}
+		}
+		checkpoints.push_back(ub_time);
+		return checkpoints;
+	}
+
+	static string checkpoint_name(double t) {
+		ostringstream os;
+		os << "T" << t;
+		return os.str();
+	}
+
+	static string format_value(double v) {
+		if (v == inf) { return "inf"; }
+		ostringstream os;
+		os.precision(10);
+		os << v;
+		return os.str();
+	}
+
+	/// 按(α, β)把曲线上的每次改进与`obj_map`参考值比较，返回首次达到`target_ratio`的时间
+	static double cal_time_to_target(const string& ins_name, const vector<AdaptiveSelecter::Improvement>& improvements, const Config& cfg, double target_ratio) {
+		auto ref = obj_map.find(ins_name);
+		if (ref == obj_map.end()) { return inf; }
+		for (auto& imp : improvements) {
+			double score = (cfg.alpha * imp.area / ref->second.first + cfg.beta * imp.wirelength / ref->second.second) / (cfg.alpha + cfg.beta);
+			if (score <= target_ratio) { return imp.time; }
+		}
+		return inf;
+	}
+
+	/// 所有(算例, 种子)组合共享一个线程池；线程数多于核数时墙钟曲线会变差，比较两个版本应使用相同的线程数
+	static vector<Run> run_all(const vector<pair<string, string>>& ins_names, const Config& base_cfg, int seed_num,
+		const vector<double>& checkpoints, double target_ratio, int thread_num) {
+		struct Job {
+			pair<string, string> ins;
+			Config cfg;
+			Run run;
+		};
+		vector<Job> jobs;
+		for (auto& ins : ins_names) {
+			for (int s = 1; s <= seed_num; ++s) { // 种子固定为1..N，不同版本在相同种子上比较
+				jobs.push_back({ ins, base_cfg, {} });
+				jobs.back().cfg.random_seed = s;
+			}
+		}
+		{
+			utils::ThreadPool pool(thread_num);
+			for (auto& job : jobs) {
+				pool.submit([&job, &checkpoints, target_ratio] {
+					Environment env(job.ins.first, "H", job.ins.second);
+					AdaptiveSelecter asa(env, job.cfg);
+					asa.run();
+					auto& improvements = asa.get_improvements();
+					job.run.ins_name = job.ins.second;
+					job.run.seed = job.cfg.random_seed;
+					for (double t : checkpoints) {
+						double best = inf;
+						for (auto& imp : improvements) {
+							if (imp.time <= t) { best = min(best, imp.objective); }
+						}
+						job.run.curve.push_back(best);
+					}
+					job.run.final_objective = improvements.empty() ? inf : asa.get_best_objective();
+					job.run.time_to_target = cal_time_to_target(job.ins.second, improvements, job.cfg, target_ratio);
+				});
+			}
+		}
+		vector<Run> runs;
+		for (auto& job : jobs) { runs.push_back(move(job.run)); }
+		return runs;
+	}
+
+	/// 每次运行一行：Instance,Seed,TimeToTarget,Final,T<检查点>...
+	static void write_runs(const string& path, const vector<Run>& runs, const vector<double>& checkpoints) {
+		ofstream file(path);
+		file << "Instance,Seed,TimeToTarget,Final";
+		for (double t : checkpoints) { file << "," << checkpoint_name(t); }
+		file << endl;
+		for (auto& run : runs) {
+			file << run.ins_name << "," << run.seed << "," << format_value(run.time_to_target) << "," << format_value(run.final_objective);
+			for (double v : run.curve) { file << "," << format_value(v); }
+			file << endl;
+		}
+	}
+
+	/// 读入`write_runs`的输出：算例 -> 指标名 -> 各次运行的值
+	static map<string, map<string, vector<double>>> read_runs(const string& path) {
+		map<string, map<string, vector<double>>> table;
+		ifstream file(path);
+		if (!file) {
+			fprintf(stderr, "%s: no runs file\n", path.c_str());
+			return table;
+		}
+		auto split = [](const string& line) {
+			vector<string> cells;
+			istringstream is(line);
+			for (string cell; getline(is, cell, ',');) { cells.push_back(cell); }
+			return cells;
+		};
+		string line;
+		getline(file, line);
+		vector<string> header = split(line);
+		while (getline(file, line)) {
+			vector<string> cells = split(line);
+			if (cells.size() != header.size()) { continue; }
+			for (int c = 2; c < cells.size(); ++c) { table[cells[0]][header[c]].push_back(strtod(cells[c].c_str(), nullptr)); }
+		}
+		return table;
+	}
+
+	/// 每个(算例, 指标)一行：中位数、95%置信区间、得到有限值的运行比例
+	static void write_summary(const string& path, const vector<Run>& runs, const vector<double>& checkpoints) {
+		map<string, map<string, vector<double>>> table;
+		for (auto& run : runs) {
+			table[run.ins_name]["TimeToTarget"].push_back(run.time_to_target);
+			table[run.ins_name]["Final"].push_back(run.final_objective);
+			for (int k = 0; k < checkpoints.size(); ++k) { table[run.ins_name][checkpoint_name(checkpoints[k])].push_back(run.curve[k]); }
+		}
+		ofstream file(path);
+		file << "Instance,Metric,Median,CILow,CIHigh,Reached,Runs" << endl;
+		for (auto& ins : table) {
+			vector<string> metrics = { "TimeToTarget", "Final" };
+			for (double t : checkpoints) { metrics.push_back(checkpoint_name(t)); }
+			for (auto& metric : metrics) {
+				auto& values = ins.second[metric];
+				MedianCI ci = median_ci(values);
+				int reached = count_if(values.begin(), values.end(), [](double v) { return v != inf; });
+				file << ins.first << "," << metric << "," << format_value(ci.median) << "," << format_value(ci.low) << ","
+					<< format_value(ci.high) << "," << 1.0 * reached / values.size() << "," << values.size() << endl;
+			}
+			MedianCI final_ci = median_ci(ins.second["Final"]), ttt_ci = median_ci(ins.second["TimeToTarget"]);
+			fprintf(stdout, "%-8s final %s [%s, %s], time to target %s [%s, %s]\n", ins.first.c_str(),
+				format_value(final_ci.median).c_str(), format_value(final_ci.low).c_str(), format_value(final_ci.high).c_str(),
+				format_value(ttt_ci.median).c_str(), format_value(ttt_ci.low).c_str(), format_value(ttt_ci.high).c_str());
+		}
+	}
+
+	/// 比较两个版本的runs文件：对每个共有的(算例, 指标)做Mann-Whitney U检验，Holm法控制多重比较的总体显著性水平；
+	/// 新版本中位数变差且显著即为回归，返回回归数目
+	static int compare(const string& base_path, const string& new_path, double alpha) {
+		auto base_table = read_runs(base_path), new_table = read_runs(new_path);
+		struct Test {
+			string ins_name, metric;
+			double base_median, new_median, p;
+		};
+		vector<Test> tests;
+		for (auto& ins : base_table) {
+			if (!new_table.count(ins.first)) { continue; }
+			for (auto& metric : ins.second) {
+				auto iter = new_table[ins.first].find(metric.first);
+				if (iter == new_table[ins.first].end()) { continue; }
+				tests.push_back({ ins.first, metric.first, median_ci(metric.second).median, median_ci(iter->second).median,
+					mann_whitney_p(metric.second, iter->second) });
+			}
+		}
+		vector<int> order(tests.size());
+		iota(order.begin(), order.end(), 0);
+		sort(order.begin(), order.end(), [&](int lhs, int rhs) { return tests[lhs].p < tests[rhs].p; });
+		vector<bool> is_significant(tests.size(), false);
+		for (int i = 0; i < order.size(); ++i) {
+			if (tests[order[i]].p > alpha / (order.size() - i)) { break; }
+			is_significant[order[i]] = true;
+		}
+		int regression_num = 0;
+		for (int i = 0; i < tests.size(); ++i) {
+			const Test& test = tests[i];
+			const char* verdict = !is_significant[i] ? "" : test.new_median > test.base_median ? "REGRESSION" : "improved";
+			if (is_significant[i] && test.new_median > test.base_median) { ++regression_num; }
+			fprintf(stdout, "%-8s %-14s %16s %16s  p=%.4f  %s\n", test.ins_name.c_str(), test.metric.c_str(),
+				format_value(test.base_median).c_str(), format_value(test.new_median).c_str(), test.p, verdict);
+		}
+		fprintf(stdout, "%zu tests, %d significant regressions at alpha %.3f (Holm).\n", tests.size(), regression_num, alpha);
+		return regression_num;
+	}
+
+}
+
+
+int main(int argc, char** argv) {
+
+	// Harness run [--seeds <N>] [--time <秒>] [--threads <线程数>] [--packer rls|bs|portfolio] [--target-ratio <比例>]
+	//             [--ins <算例名>]... [--out <输出前缀>]
+	//   每个算例跑N个种子，输出<前缀>.runs.csv(每次运行的质量-时间曲线)和<前缀>.summary.csv(中位数及95%置信区间)
+	// Harness compare <基准.runs.csv> <新版本.runs.csv> [--alpha <显著性水平>]
+	//   新版本有显著变差的指标时返回1
+	if (argc >= 4 && string(argv[1]) == "compare") {
+		double alpha = 0.05;
+		for (int i = 4; i < argc; ++i) {
+			string arg = argv[i];
+			if (arg == "--alpha" && i + 1 < argc) { alpha = atof(argv[++i]); }
+			else { fprintf(stderr, "unknown option: %s\n", arg.c_str()); return 2; }
+		}
+		return harness::compare(argv[2], argv[3], alpha) > 0 ? 1 : 0;
+	}
+	if (argc < 2 || string(argv[1]) != "run") {
+		fprintf(stderr, "usage: %s run [--seeds n] [--time s] [--threads n] [--packer rls|bs|portfolio] [--target-ratio r] [--ins name]... [--out prefix]\n"
+			"       %s compare <base.runs.csv> <new.runs.csv> [--alpha a]\n", argv[0], argv[0]);
+		return 2;
+	}
+
+	Config run_cfg = cfg;
+	run_cfg.ub_time = 10;
+	run_cfg.quiet = true;
+	int seed_num = 10, thread_num = max(1u, thread::hardware_concurrency());
+	double target_ratio = 1;
+	string out_prefix = "Solution/Harness." + utils::Date::to_long_str();
+	vector<pair<string, string>> ins_names;
+	for (int i = 2; i < argc; ++i) {
+		string arg = argv[i];
+		if (i + 1 >= argc) { fprintf(stderr, "missing value: %s\n", arg.c_str()); return 2; }
+		if (arg == "--seeds") { seed_num = atoi(argv[++i]); }
+		else if (arg == "--time") { run_cfg.ub_time = atoi(argv[++i]); }
+		else if (arg == "--threads") { thread_num = atoi(argv[++i]); }
+		else if (arg == "--target-ratio") { target_ratio = atof(argv[++i]); }
+		else if (arg == "--out") { out_prefix = argv[++i]; }
+		else if (arg == "--packer") {
+			string packer = argv[++i];
+			if (packer == "rls") { run_cfg.level_asa_fbp = Config::LevelFloorplanPacker::RandomLocalSearch; }
+			else if (packer == "bs") { run_cfg.level_asa_fbp = Config::LevelFloorplanPacker::BeamSearch; }
+			else if (packer == "portfolio") { run_cfg.level_asa_fbp = Config::LevelFloorplanPacker::Portfolio; }
+			else { fprintf(stderr, "unknown packer: %s\n", packer.c_str()); return 2; }
+		}
+		else if (arg == "--ins") {
+			string name = argv[++i];
+			auto iter = find_if(ins_list.begin(), ins_list.end(), [&](auto& ins) { return ins.second == name; });
+			ins_names.push_back(iter != ins_list.end() ? *iter : make_pair(string("GSRC"), name)); // 不在列表中的按GSRC目录查找(合成算例)
+		}
+		else { fprintf(stderr, "unknown option: %s\n", arg.c_str()); return 2; }
+	}
+	if (ins_names.empty()) { ins_names = ins_list; }
+
+	vector<double> checkpoints = harness::default_checkpoints(run_cfg.ub_time);
+	auto sweep_start = chrono::steady_clock::now();
+	vector<harness::Run> runs = harness::run_all(ins_names, run_cfg, seed_num, checkpoints, target_ratio, thread_num);
+	double sweep_duration = chrono::duration<double>(chrono::steady_clock::now() - sweep_start).count();
+
+	harness::write_runs(out_prefix + ".runs.csv", runs, checkpoints);
+	harness::write_summary(out_prefix + ".summary.csv", runs, checkpoints);
+	fprintf(stdout, "harness: %zu runs (%zu instances x %d seeds) on %d threads in %.2fs, written to %s.*.csv\n",
+		runs.size(), ins_names.size(), seed_num, thread_num, sweep_duration, out_prefix.c_str());
+	return 0;
+}
@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <unordered_map>
 
 #include "Data.hpp"
 #include "Utils.hpp"
@@ -20,12 +21,20 @@ public:
 	string blocks_path() const { return instance_dir() + benchmark_dir() + type_dir() + _ins_name + ".blocks"; }
 	string nets_path() const { return instance_dir() + benchmark_dir() + type_dir() + _ins_name + ".nets"; }
 	string pl_path() const { return instance_dir() + benchmark_dir() + type_dir() + _ins_name + ".pl"; }
+	string eco_path() const { return instance_dir() + benchmark_dir() + type_dir() + _ins_name + ".eco"; }
 	string pl_html_path() const { return instance_dir() + benchmark_dir() + type_dir() + _ins_name + ".html"; }
 	string fp_path() const { return solution_dir() + benchmark_dir() + _ins_name + ".fp"; }
 	string fp_path_with_time() const { return solution_dir() + benchmark_dir() + _ins_name + "." + utils::Date::to_long_str() + ".fp"; }
 	string fp_html_path() const { return solution_dir() + benchmark_dir() + _ins_name + ".html"; }
 	string fp_html_path_with_time() const { return solution_dir() + benchmark_dir() + _ins_name + "." + utils::Date::to_long_str() + ".html"; }
+	string fp_path_with_seed(unsigned int seed) const { return solution_dir() + benchmark_dir() + _ins_name + ".s" + to_string(seed) + ".fp"; }
+	string fp_html_path_with_seed(unsigned int seed) const { return solution_dir() + benchmark_dir() + _ins_name + ".s" + to_string(seed) + ".html"; }
+	string pareto_path() const { return solution_dir() + benchmark_dir() + _ins_name + ".pareto.csv"; }
+	string checkpoint_path(unsigned int seed) const { return solution_dir() + benchmark_dir() + _ins_name + ".s" + to_string(seed) + ".ckpt"; }
+	string trace_path(unsigned int seed) const { return solution_dir() + benchmark_dir() + _ins_name + ".s" + to_string(seed) + ".trace.jsonl"; }
 	string log_path() const { return solution_dir() + _ins_bench + ".csv"; }
+	string memory_path() const { return solution_dir() + _ins_bench + ".memory.csv"; }
+	string profile_path() const { return solution_dir() + _ins_bench + ".profile.csv"; }
 
 private:
 	static string instance_dir() { return "Instance/"; }
@@ -43,6 +52,24 @@ class Instance {
 public:
 	Instance(const Environment& env) : _env(env), _fixed_width(0), _fixed_height(0) { read_instance(); }
 
+	/// ڴй(еĴ)terminalnet_ids`nets`
+	Instance(const Environment& env, vector<Block> blocks, vector<Terminal> terminals, vector<Net> nets, int fixed_width = 0, int fixed_height = 0) :
+		_env(env), _fixed_width(fixed_width), _fixed_height(fixed_height),
+		_blocks(move(blocks)), _block_num(_blocks.size()), _total_area(0),
+		_terminals(move(terminals)), _terminal_num(_terminals.size()),
+		_nets(move(nets)), _net_num(_nets.size()), _pin_num(0) {
+		for (auto& block : _blocks) {
+			block.area = block.width * block.height;
+			_total_area += block.area;
+		}
+		for (int i = 0; i < _net_num; ++i) {
+			for (int bid : _nets[i].block_list) { _blocks[bid].net_ids.push_back(i); }
+			for (int tid : _nets[i].terminal_list) { _terminals[tid].net_ids.push_back(i); }
+			_nets[i].degree = _nets[i].block_list.size() + _nets[i].terminal_list.size();
+			_pin_num += _nets[i].degree;
+		}
+	}
+
 	/// бĬwhж
 	vector<Rect> get_rects(bool rotated = true) const {
 		vector<Rect> rects;
@@ -80,6 +107,17 @@ public:
 	int get_fixed_width() const { return _fixed_width; }
 	int get_fixed_height() const { return _fixed_height; }
 
+	/// 顢terminalڶϵֽ
+	void account_memory(utils::MemoryUsage& usage) const {
+		long long blocks = utils::heap_bytes(_blocks), terminals = utils::heap_bytes(_terminals), nets = utils::heap_bytes(_nets);
+		for (auto& block : _blocks) { blocks += utils::heap_bytes(block.name) + utils::heap_bytes(block.net_ids); }
+		for (auto& terminal : _terminals) { terminals += utils::heap_bytes(terminal.name) + utils::heap_bytes(terminal.net_ids); }
+		for (auto& net : _nets) { nets += utils::heap_bytes(net.block_list) + utils::heap_bytes(net.terminal_list); }
+		usage.resident["instance.blocks"] += blocks;
+		usage.resident["instance.terminals"] += terminals;
+		usage.resident["instance.nets"] += nets;
+	}
+
 private:
 	void read_instance() {
 		read_blocks();
@@ -135,6 +173,9 @@ private:
 		fscanf(file, "NumNets : %d\n", &_net_num);
 		fscanf(file, "NumPins : %d\n", &_pin_num);
 
+		unordered_map<string, int> block_ids, terminal_ids; // ֲңģ±Ƚ
+		for (int i = 0; i < _block_num; ++i) { block_ids[_blocks[i].name] = i; }
+		for (int i = 0; i < _terminal_num; ++i) { terminal_ids[_terminals[i].name] = i; }
 		_nets.resize(_net_num);
 		for (int i = 0; i < _net_num; ++i) {
 			fscanf(file, "NetDegree : %d\n", &_nets[i].degree);
@@ -144,18 +185,16 @@ private:
 				if (tmp_char[0] == '#') { --d; }
 				else {
 					string tmp_name = tmp_char;
-					auto block_iter = find_if(_blocks.begin(), _blocks.end(),
-						[&tmp_name](Block& block) { return  block.name == tmp_name; });
-					if (block_iter != _blocks.end()) { // it's a block
-						block_iter->net_ids.push_back(i);
-						_nets[i].block_list.push_back(distance(_blocks.begin(), block_iter));
+					auto block_iter = block_ids.find(tmp_name);
+					if (block_iter != block_ids.end()) { // it's a block
+						_blocks[block_iter->second].net_ids.push_back(i);
+						_nets[i].block_list.push_back(block_iter->second);
 					}
 					else { // it's a terminal
-						auto terminal_iter = find_if(_terminals.begin(), _terminals.end(),
-							[&tmp_name](Terminal& terminal) { return terminal.name == tmp_name; });
-						assert(terminal_iter != _terminals.end());
-						terminal_iter->net_ids.push_back(i);
-						_nets[i].terminal_list.push_back(distance(_terminals.begin(), terminal_iter));
+						auto terminal_iter = terminal_ids.find(tmp_name);
+						assert(terminal_iter != terminal_ids.end());
+						_terminals[terminal_iter->second].net_ids.push_back(i);
+						_nets[i].terminal_list.push_back(terminal_iter->second);
 					}
 				}
 			}
@@ -176,15 +215,17 @@ private:
 
 		utils::skip(file, 5);
 
+		unordered_map<string, int> block_ids, terminal_ids;
+		for (int i = 0; i < _block_num; ++i) { block_ids[_blocks[i].name] = i; }
+		for (int i = 0; i < _terminal_num; ++i) { terminal_ids[_terminals[i].name] = i; }
 		for (int i = 0; i < _block_num; ++i) {
 			char block_name[10];
 			int x, y;
 			fscanf(file, "%s %d %d\n", block_name, &x, &y);
-			auto iter = find_if(_blocks.begin(), _blocks.end(),
-				[&block_name](Block& block) { return block.name == string(block_name); });
-			assert(iter != _blocks.end());
-			iter->x_coordinate = x;
-			iter->y_coordinate = y;
+			auto iter = block_ids.find(block_name);
+			assert(iter != block_ids.end());
+			_blocks[iter->second].x_coordinate = x;
+			_blocks[iter->second].y_coordinate = y;
 			_fixed_width = max(_fixed_width, x);
 			_fixed_height = max(_fixed_height, y);
 		}
@@ -193,11 +234,10 @@ private:
 			char terminal_name[10];
 			int x, y;
 			fscanf(file, "%s %d %d\n", terminal_name, &x, &y);
-			auto iter = find_if(_terminals.begin(), _terminals.end(),
-				[&terminal_name](Terminal& terminal) { return terminal.name == string(terminal_name); });
-			assert(iter != _terminals.end());
-			iter->x_coordinate = x;
-			iter->y_coordinate = y;
+			auto iter = terminal_ids.find(terminal_name);
+			assert(iter != terminal_ids.end());
+			_terminals[iter->second].x_coordinate = x;
+			_terminals[iter->second].y_coordinate = y;
 			_fixed_width = max(_fixed_width, x);
 			_fixed_height = max(_fixed_height, y);
 		}
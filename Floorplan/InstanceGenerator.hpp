@@ -0,0 +1,260 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "Instance.hpp"
+
+using namespace std;
+
+/// 生成GSRC格式(.blocks/.nets/.pl)的合成算例，用于1k~1M块的规模测试
+/// 块按编号排在g×g的网格上(g=⌈√n⌉)，线网的其余引脚在种子块附近的窗口内选取，
+/// 窗口半径服从幂律分布P(l)∝l^(2p-4)，p为Rent指数：p越大长线网越多
+/// 随机数只使用mt19937的原始输出，同一种子在不同平台上生成相同的算例
+class InstanceGenerator {
+public:
+	struct Param {
+		int block_num = 1000;
+		int terminal_num = -1;        // 小于0时取4√n
+		double area_mean = 900;       // 块面积服从对数正态分布，均值和对数标准差
+		double area_sigma = 0.8;
+		double max_aspect_ratio = 3;  // 长宽比在[1, max_aspect_ratio]上对数均匀分布
+		double net_ratio = 3;         // 块之间的线网数 = net_ratio * block_num
+		double degree_mean = 3;       // 线网度数为2加上几何分布，截断于max_degree
+		int max_degree = 16;
+		double rent_exponent = 0.6;
+		unsigned int seed = 1;
+	};
+
+	InstanceGenerator(const Param& param) : _param(param), _gen(param.seed) {
+		if (_param.terminal_num < 0) { _param.terminal_num = static_cast<int>(4 * sqrt(_param.block_num)); }
+		_grid = static_cast<int>(ceil(sqrt(_param.block_num)));
+	}
+
+	/// 生成并写入`env`对应的三个文件，面积总和超出int范围时失败
+	bool generate(const Environment& env) {
+		return generate_all(env) && write_blocks(env.blocks_path()) && write_nets(env.nets_path()) && write_pl(env.pl_path());
+	}
+
+	/// 生成内存中的算例，不写文件；坐标为初始排版
+	Instance make_instance(const Environment& env) {
+		generate_all(env);
+		vector<Block> blocks(_param.block_num);
+		for (int i = 0; i < _param.block_num; ++i) {
+			blocks[i].name = "sb" + to_string(i);
+			blocks[i].x_coordinate = _xs[i];
+			blocks[i].y_coordinate = _ys[i];
+			blocks[i].width = _widths[i];
+			blocks[i].height = _heights[i];
+		}
+		vector<Terminal> terminals(_param.terminal_num);
+		for (int t = 0; t < _param.terminal_num; ++t) {
+			terminals[t].name = "p" + to_string(t + 1);
+			terminals[t].x_coordinate = _terminal_xs[t];
+			terminals[t].y_coordinate = _terminal_ys[t];
+		}
+		return Instance(env, move(blocks), move(terminals), _nets);
+	}
+
+private:
+	bool generate_all(const Environment& env) {
+		_gen.seed(_param.seed);
+		generate_blocks();
+		if (_total_area > INT_MAX) {
+			fprintf(stderr, "%s: total area %lld exceeds int range, reduce block_num or area_mean\n", env._ins_name.c_str(), _total_area);
+			return false;
+		}
+		generate_placement();
+		generate_terminals();
+		generate_nets();
+		return true;
+	}
+
+	/// [0, 1)上均匀分布
+	double uniform() { return _gen() / 4294967296.0; }
+
+	/// 对数正态分布的面积 + 对数均匀分布的长宽比，随机横竖
+	void generate_blocks() {
+		_widths.resize(_param.block_num);
+		_heights.resize(_param.block_num);
+		_total_area = 0;
+		double mu = log(_param.area_mean) - _param.area_sigma * _param.area_sigma / 2;
+		for (int i = 0; i < _param.block_num; ++i) {
+			double normal = sqrt(-2 * log(1 - uniform())) * cos(2 * acos(-1.0) * uniform()); // Box-Muller
+			double area = exp(mu + _param.area_sigma * normal);
+			double ratio = exp(uniform() * log(_param.max_aspect_ratio));
+			if (uniform() < 0.5) { ratio = 1 / ratio; }
+			_widths[i] = max(1, static_cast<int>(round(sqrt(area * ratio))));
+			_heights[i] = max(1, static_cast<int>(round(sqrt(area / ratio))));
+			_total_area += 1LL * _widths[i] * _heights[i];
+		}
+	}
+
+	/// 初始排版：网格的每行排成一层，给出合法的.pl，并确定terminal所在的外框
+	void generate_placement() {
+		_xs.resize(_param.block_num);
+		_ys.resize(_param.block_num);
+		_outline_width = _outline_height = 0;
+		for (int row_start = 0; row_start < _param.block_num; row_start += _grid) {
+			int x = 0, row_height = 0;
+			for (int i = row_start; i < min(row_start + _grid, _param.block_num); ++i) {
+				_xs[i] = x;
+				_ys[i] = _outline_height;
+				x += _widths[i];
+				row_height = max(row_height, _heights[i]);
+			}
+			_outline_width = max(_outline_width, x);
+			_outline_height += row_height;
+		}
+	}
+
+	/// terminal沿外框逆时针均匀分布
+	void generate_terminals() {
+		_terminal_xs.resize(_param.terminal_num);
+		_terminal_ys.resize(_param.terminal_num);
+		long long perimeter = 2LL * (_outline_width + _outline_height);
+		for (int t = 0; t < _param.terminal_num; ++t) {
+			long long s = perimeter * t / _param.terminal_num;
+			if (s < _outline_width) { _terminal_xs[t] = s; _terminal_ys[t] = 0; }
+			else if ((s -= _outline_width) < _outline_height) { _terminal_xs[t] = _outline_width; _terminal_ys[t] = s; }
+			else if ((s -= _outline_height) < _outline_width) { _terminal_xs[t] = _outline_width - s; _terminal_ys[t] = _outline_height; }
+			else { s -= _outline_width; _terminal_xs[t] = 0; _terminal_ys[t] = _outline_height - s; }
+		}
+	}
+
+	/// 块之间的线网以随机块为种子；每个terminal各连一个线网，种子取外框上离它最近的网格单元
+	void generate_nets() {
+		_nets.clear();
+		long long net_num = static_cast<long long>(_param.net_ratio * _param.block_num);
+		for (long long i = 0; i < net_num; ++i) {
+			Net net;
+			net.block_list = sample_pins(_gen() % _param.block_num, sample_degree());
+			_nets.push_back(move(net));
+		}
+		for (int t = 0; t < _param.terminal_num; ++t) {
+			int cx = min(_grid - 1, static_cast<int>(1LL * _terminal_xs[t] * _grid / max(1, _outline_width)));
+			int cy = min(row_num() - 1, static_cast<int>(1LL * _terminal_ys[t] * row_num() / max(1, _outline_height)));
+			Net net;
+			net.block_list = sample_pins(min(_param.block_num - 1, cy * _grid + cx), sample_degree() - 1);
+			net.terminal_list.push_back(t);
+			_nets.push_back(move(net));
+		}
+	}
+
+	int row_num() const { return (_param.block_num + _grid - 1) / _grid; }
+
+	/// 度数 = 2 + 几何分布(均值degree_mean-2)，截断于max_degree和块数
+	int sample_degree() {
+		double extra = max(0.0, _param.degree_mean - 2);
+		int degree = 2 + static_cast<int>(floor(log(1 - uniform()) / log(extra / (extra + 1) + 1e-12)));
+		return max(2, min({ degree, _param.max_degree, _param.block_num }));
+	}
+
+	/// 窗口半径l∈[1, g]按密度l^(2p-4)取逆变换采样
+	double sample_radius() {
+		double b = 2 * _param.rent_exponent - 3;
+		return pow(1 + uniform() * (pow(_grid, b) - 1), 1 / b);
+	}
+
+	/// 以`seed`为中心取`degree`个不同的块；窗口内多次取不到新块时放宽到整个网格
+	vector<int> sample_pins(int seed, int degree) {
+		vector<int> pins = { seed };
+		int cx = seed % _grid, cy = seed / _grid;
+		while (pins.size() < degree) {
+			int radius = max(1, static_cast<int>(sample_radius()));
+			int pin = -1;
+			for (int attempt = 0; attempt < 32 && pin < 0; ++attempt) {
+				int x = cx + static_cast<int>(_gen() % (2 * radius + 1)) - radius;
+				int y = cy + static_cast<int>(_gen() % (2 * radius + 1)) - radius;
+				int candidate = y * _grid + x;
+				if (x < 0 || x >= _grid || y < 0 || candidate >= _param.block_num) { continue; }
+				if (find(pins.begin(), pins.end(), candidate) == pins.end()) { pin = candidate; }
+			}
+			while (pin < 0) {
+				int candidate = _gen() % _param.block_num;
+				if (find(pins.begin(), pins.end(), candidate) == pins.end()) { pin = candidate; }
+			}
+			pins.push_back(pin);
+		}
+		return pins;
+	}
+
+	/// 文件头的注释行记录生成参数，不含日期，同一参数生成的文件逐字节相同
+	string header() const {
+		char buf[256];
+		snprintf(buf, sizeof(buf), "# Created      : InstanceGenerator\n# Seed         : %u\n"
+			"# Param        : area %.0f/%.2f, aspect %.2f, nets %.2f, degree %.2f/%d, rent %.2f\n\n",
+			_param.seed, _param.area_mean, _param.area_sigma, _param.max_aspect_ratio,
+			_param.net_ratio, _param.degree_mean, _param.max_degree, _param.rent_exponent);
+		return buf;
+	}
+
+	bool write_blocks(const string& path) const {
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == 0) {
+			fprintf(stderr, "%s: cannot write blocks file\n", path.c_str());
+			return false;
+		}
+		fprintf(file, "UCSC blocks 1.0\n%s", header().c_str());
+		fprintf(file, "NumSoftRectangularBlocks : 0\nNumHardRectilinearBlocks : %d\nNumTerminals : %d\n\n", _param.block_num, _param.terminal_num);
+		for (int i = 0; i < _param.block_num; ++i) {
+			fprintf(file, "sb%d hardrectilinear 4 (0, 0) (0, %d) (%d, %d) (%d, 0)\n", i, _heights[i], _widths[i], _heights[i], _widths[i]);
+		}
+		fprintf(file, "\n");
+		for (int t = 0; t < _param.terminal_num; ++t) { fprintf(file, "p%d terminal\n", t + 1); }
+		fclose(file);
+		return true;
+	}
+
+	bool write_nets(const string& path) const {
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == 0) {
+			fprintf(stderr, "%s: cannot write nets file\n", path.c_str());
+			return false;
+		}
+		long long pin_num = 0;
+		for (auto& net : _nets) { pin_num += net.block_list.size() + net.terminal_list.size(); }
+		fprintf(file, "UCLA nets 1.0\n%s", header().c_str());
+		fprintf(file, "NumNets : %zu\nNumPins : %lld\n", _nets.size(), pin_num);
+		for (auto& net : _nets) {
+			fprintf(file, "NetDegree : %zu\n", net.block_list.size() + net.terminal_list.size());
+			for (int t : net.terminal_list) { fprintf(file, "p%d B\n", t + 1); }
+			for (int b : net.block_list) { fprintf(file, "sb%d B\n", b); }
+		}
+		fclose(file);
+		return true;
+	}
+
+	bool write_pl(const string& path) const {
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == 0) {
+			fprintf(stderr, "%s: cannot write pl file\n", path.c_str());
+			return false;
+		}
+		fprintf(file, "UCSC blocks 1.0\n%s", header().c_str());
+		for (int i = 0; i < _param.block_num; ++i) { fprintf(file, "sb%d\t%d\t%d\n", i, _xs[i], _ys[i]); }
+		fprintf(file, "\n");
+		for (int t = 0; t < _param.terminal_num; ++t) { fprintf(file, "p%d\t%d\t%d\n", t + 1, _terminal_xs[t], _terminal_ys[t]); }
+		fclose(file);
+		return true;
+	}
+
+private:
+	Param _param;
+	mt19937 _gen;
+	int _grid;
+
+	vector<int> _widths, _heights;
+	long long _total_area;
+	vector<int> _xs, _ys;
+	int _outline_width, _outline_height;
+	vector<int> _terminal_xs, _terminal_ys;
+	vector<Net> _nets;
+};
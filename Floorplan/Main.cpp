@@ -63,13 +63,12 @@ namespace test {
 		vector<Rect> src = ins.get_rects();
 		double dead_ratio = 1.05;
 		int bin_width = ceil(sqrt(dead_ratio * ins.get_total_area()));
-		default_random_engine gen(cfg.random_seed);
 
 		printf("Perform the packing...\n");
 
 		vector<shared_ptr<FloorplanPacker>> fbp_solvers;
-		fbp_solvers.push_back(make_shared<RandomLocalSearcher>(ins, src, bin_width, gen));
-		fbp_solvers.push_back(make_shared<BeamSearcher>(ins, src, bin_width, gen));
+		fbp_solvers.push_back(make_shared<RandomLocalSearcher>(ins, src, bin_width, cfg.random_seed));
+		fbp_solvers.push_back(make_shared<BeamSearcher>(ins, src, bin_width, cfg.random_seed));
 		for_each(fbp_solvers.begin(), fbp_solvers.end(), [&](auto& fbp_solver) {
 			fbp_solver->run(1, cfg.alpha, cfg.beta, cfg.level_fbp_wl, cfg.level_fbp_dist);
 			if (fbp_solver->get_dst().size() != ins.get_block_num()) { printf("Failed!\n"); }
@@ -90,20 +89,88 @@ void run_single_ins(const string& ins_bench, const string& ins_name) {
 	asa.draw_fp(env.fp_html_path(), cfg.beta);
 	asa.draw_fp(env.fp_html_path_with_time(), cfg.beta);
 	asa.record_log();
+	if (cfg.pareto_archive) { asa.record_pareto(env.pareto_path()); }
 }
 
 
 void run_all_ins() { for_each(ins_list.begin(), ins_list.end(), [](auto& ins) { run_single_ins(ins.first, ins.second); }); }
 
 
+/// 批量模式：(算例, 随机种子, 参数)组合成任务，所有任务共享一个线程池，结束后汇报整体吞吐量
+void run_batch(const vector<Config>& cfgs, int seed_num, int thread_num = max(1u, thread::hardware_concurrency())) {
+	struct BatchJob {
+		pair<string, string> ins;
+		Config cfg;
+		double duration;
+	};
+	vector<BatchJob> jobs;
+	for (auto& job_cfg : cfgs) {
+		for (auto& ins : ins_list) {
+			for (int s = 0; s < seed_num; ++s) {
+				jobs.push_back({ ins, job_cfg, 0 });
+				jobs.back().cfg.random_seed = job_cfg.random_seed + s;
+			}
+		}
+	}
+
+	auto sweep_start = chrono::steady_clock::now();
+	{
+		utils::ThreadPool pool(thread_num);
+		for (auto& job : jobs) {
+			pool.submit([&job] {
+				auto job_start = chrono::steady_clock::now();
+				Environment env(job.ins.first, "H", job.ins.second);
+				AdaptiveSelecter asa(env, job.cfg);
+				asa.run();
+				asa.draw_ins();
+				asa.record_fp(env.fp_path_with_seed(job.cfg.random_seed));
+				asa.draw_fp(env.fp_html_path_with_seed(job.cfg.random_seed), job.cfg.beta);
+				asa.record_log();
+				job.duration = chrono::duration<double>(chrono::steady_clock::now() - job_start).count();
+			});
+		}
+	}
+	double sweep_duration = chrono::duration<double>(chrono::steady_clock::now() - sweep_start).count();
+	double job_duration = accumulate(jobs.begin(), jobs.end(), 0.0, [](double sum, auto& job) { return sum + job.duration; });
+
+	fprintf(stdout, "batch: %zu jobs on %d threads, wall %.2fs, job total %.2fs, speedup %.2f, %.2f jobs/hour\n",
+		jobs.size(), thread_num, sweep_duration, job_duration, job_duration / sweep_duration, jobs.size() * 3600.0 / sweep_duration);
+	ofstream log_file("Solution/Batch.csv", ios::app);
+	log_file.seekp(0, ios::end);
+	if (log_file.tellp() <= 0) { log_file << "Date,Jobs,Threads,WallTime,JobTime,Speedup,JobsPerHour" << endl; }
+	log_file << utils::Date::to_long_str() << "," << jobs.size() << "," << thread_num << "," << sweep_duration << ","
+		<< job_duration << "," << job_duration / sweep_duration << "," << jobs.size() * 3600.0 / sweep_duration << endl;
+}
+
+
 int main(int argc, char** argv) {
 
+	// --checkpoint <秒>：定期保存检查点；--resume：从检查点继续(进程被杀后以相同参数重新启动)
+	// --trace <秒>：输出收敛轨迹(JSON lines)，记录每次改进并按间隔输出各候选宽度的访问次数
+	// --warm-start：从Solution/<bench>/<name>.fp中上次的解开始搜索
+	// --eco：增量重布局，<name>.eco列出尺寸或线网有变化的块名，只重新打包上次解中受影响的部分
+	// --multilevel：多层聚类流程，用于上万块的算例
+	// --partition <份数>：按线网划分后各份并行求解，再拼接为整体布局
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (arg == "--resume") { cfg.resume = true; }
+		else if (arg == "--warm-start") { cfg.warm_start = true; }
+		else if (arg == "--eco") { cfg.eco = true; }
+		else if (arg == "--multilevel") { cfg.multilevel = true; }
+		else if (arg == "--partition" && i + 1 < argc) { cfg.partition_num = atoi(argv[++i]); }
+		else if (arg == "--checkpoint" && i + 1 < argc) { cfg.checkpoint_interval = atof(argv[++i]); }
+		else if (arg == "--trace" && i + 1 < argc) { cfg.trace_interval = atof(argv[++i]); }
+		else { fprintf(stderr, "unknown option: %s\n", arg.c_str()); }
+	}
+
 	//test::record_gsrc_init_sol();
 
 	//test::test_floorplan_packer("MCNC", "hp");
 
 	//run_single_ins("MCNC", "hp");
 
+	//run_batch({ cfg }, 4);
+
 	run_all_ins();
 
 	return 0;
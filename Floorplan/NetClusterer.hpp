@@ -0,0 +1,161 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "Instance.hpp"
+
+namespace fbp {
+
+	using namespace std;
+
+	/// 多层流程的粗化：按连接关系把节点逐层聚成簇，直到顶层节点数不超过`top_size`
+	/// 第0层的节点是块，第L层的节点是第L-1层节点的簇
+	class NetClusterer {
+	public:
+		struct Level {
+			vector<vector<int>> members; // 每个节点包含的下一层节点，第0层为空
+			vector<vector<int>> nets;    // 投影到本层节点上的线网，节点去重，至少连两个节点
+			vector<long long> areas;
+		};
+
+		NetClusterer(const Instance& ins, int cluster_size, int top_size, unsigned int seed) : _gen(seed) {
+			Level level;
+			level.members.resize(ins.get_block_num());
+			for (auto& block : ins.get_blocks()) { level.areas.push_back(block.area); }
+			for (auto& net : ins.get_netlist()) { add_net(level.nets, net.block_list); }
+			_levels.push_back(move(level));
+			while (_levels.back().areas.size() > top_size) {
+				// 剩余层数取最少，各层簇的大小取相同：避免最后一层只剩两三个节点一簇
+				double ratio = 1.0 * _levels.back().areas.size() / top_size;
+				int level_num = max(1, static_cast<int>(ceil(log(ratio) / log(cluster_size) - 1e-9)));
+				int size = min(cluster_size, max(2, static_cast<int>(ceil(pow(ratio, 1.0 / level_num)))));
+				if (!coarsen(size)) { break; }
+			}
+		}
+
+		const vector<Level>& get_levels() const { return _levels; }
+
+	private:
+		/// 贪心聚类：随机顺序取未聚类的节点为种子，反复并入与簇连接最紧(按面积归一化)的未聚类邻居；
+		/// 簇面积不超过平均簇面积的两倍，过小的簇最后依次合并
+		bool coarsen(int size) {
+			const Level& fine = _levels.back();
+			int node_num = fine.areas.size();
+			vector<vector<pair<int, double>>> adjacency = build_adjacency(fine);
+			long long total_area = accumulate(fine.areas.begin(), fine.areas.end(), 0LL);
+			double area_limit = 2.0 * total_area * size / node_num;
+
+			vector<int> order(node_num);
+			iota(order.begin(), order.end(), 0);
+			shuffle(order.begin(), order.end(), _gen);
+			vector<int> parent(node_num, -1);
+			vector<vector<int>> clusters;
+			for (int seed : order) {
+				if (parent[seed] != -1) { continue; }
+				vector<int> cluster = { seed };
+				parent[seed] = clusters.size();
+				double area = fine.areas[seed];
+				unordered_map<int, double> conn; // 未聚类邻居 -> 与簇的连接权重
+				auto absorb = [&](int v) {
+					for (auto& edge : adjacency[v]) {
+						if (parent[edge.first] == -1) { conn[edge.first] += edge.second; }
+					}
+				};
+				absorb(seed);
+				while (cluster.size() < size && !conn.empty()) {
+					auto best = conn.end();
+					double best_score = 0;
+					for (auto iter = conn.begin(); iter != conn.end(); ++iter) {
+						double score = iter->second / (area + fine.areas[iter->first]);
+						if (best == conn.end() || score > best_score || (score == best_score && iter->first < best->first)) {
+							best = iter;
+							best_score = score;
+						}
+					}
+					int v = best->first;
+					conn.erase(best);
+					if (area + fine.areas[v] > area_limit) { continue; }
+					cluster.push_back(v);
+					parent[v] = clusters.size();
+					area += fine.areas[v];
+					absorb(v);
+				}
+				clusters.push_back(move(cluster));
+			}
+
+			// 合并过小的簇(孤立节点等)
+			vector<vector<int>> merged;
+			vector<int> pending;
+			for (auto& cluster : clusters) {
+				if (cluster.size() * 2 >= size) { merged.push_back(move(cluster)); continue; }
+				pending.insert(pending.end(), cluster.begin(), cluster.end());
+				if (pending.size() >= size) { merged.push_back(move(pending)); pending.clear(); }
+			}
+			if (!pending.empty()) { merged.push_back(move(pending)); }
+			if (merged.size() >= node_num) { return false; }
+
+			Level coarse;
+			coarse.members = move(merged);
+			for (int c = 0; c < coarse.members.size(); ++c) {
+				long long area = 0;
+				for (int v : coarse.members[c]) {
+					parent[v] = c;
+					area += fine.areas[v];
+				}
+				coarse.areas.push_back(area);
+			}
+			for (auto& net : fine.nets) {
+				vector<int> nodes; nodes.reserve(net.size());
+				for (int v : net) { nodes.push_back(parent[v]); }
+				add_net(coarse.nets, nodes);
+			}
+			_levels.push_back(move(coarse));
+			return true;
+		}
+
+		/// 线网按团模型展开，权重1/(d-1)；扇出过大的线网对聚类意义不大，忽略
+		static vector<vector<pair<int, double>>> build_adjacency(const Level& level) {
+			static constexpr int max_degree = 32;
+			vector<vector<pair<int, double>>> adjacency(level.areas.size());
+			for (auto& net : level.nets) {
+				if (net.size() > max_degree) { continue; }
+				double weight = 1.0 / (net.size() - 1);
+				for (int i = 0; i < net.size(); ++i) {
+					for (int j = 0; j < net.size(); ++j) {
+						if (i != j) { adjacency[net[i]].emplace_back(net[j], weight); }
+					}
+				}
+			}
+			for (auto& edges : adjacency) { // 合并重边
+				sort(edges.begin(), edges.end());
+				int k = -1;
+				for (auto& edge : edges) {
+					if (k >= 0 && edges[k].first == edge.first) { edges[k].second += edge.second; }
+					else { edges[++k] = edge; }
+				}
+				edges.resize(k + 1);
+			}
+			return adjacency;
+		}
+
+		static void add_net(vector<vector<int>>& nets, vector<int> nodes) {
+			sort(nodes.begin(), nodes.end());
+			nodes.erase(unique(nodes.begin(), nodes.end()), nodes.end());
+			if (nodes.size() >= 2) { nets.push_back(move(nodes)); }
+		}
+
+	private:
+		default_random_engine _gen;
+		vector<Level> _levels;
+	};
+
+}
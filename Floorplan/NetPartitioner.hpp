@@ -0,0 +1,242 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <queue>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "Instance.hpp"
+
+namespace fbp {
+
+	using namespace std;
+
+	/// 递归二分：按面积均衡、割线网最少把块划分为part_num份；二分树即切片结构，用于拼接各份的子布局
+	class NetPartitioner {
+	public:
+		struct Node {
+			int left = -1, right = -1; // 叶子为-1
+			int part = -1;             // 叶子对应的分区编号
+			long long area = 0;
+		};
+
+		NetPartitioner(const Instance& ins, int part_num, unsigned int seed) :
+			_ins(ins), _gen(seed), _local(ins.get_block_num(), -1), _net_stamp(ins.get_net_num(), -1), _stamp(0) {
+			vector<int> blocks(ins.get_block_num());
+			iota(blocks.begin(), blocks.end(), 0);
+			build(blocks, max(1, min(part_num, ins.get_block_num())));
+		}
+
+		/// 二分树，根为0号节点
+		const vector<Node>& get_nodes() const { return _nodes; }
+
+		const vector<vector<int>>& get_parts() const { return _parts; }
+
+		/// 各份非空，且恰好覆盖全部块各一次
+		bool check() const {
+			vector<int> covers(_ins.get_block_num(), 0);
+			for (auto& part : _parts) {
+				if (part.empty()) { return false; }
+				for (int b : part) { ++covers[b]; }
+			}
+			return all_of(covers.begin(), covers.end(), [](int c) { return c == 1; });
+		}
+
+		/// 跨分区的线网数目
+		int cal_cut_num() const {
+			vector<int> part_of(_ins.get_block_num());
+			for (int p = 0; p < _parts.size(); ++p) {
+				for (int b : _parts[p]) { part_of[b] = p; }
+			}
+			int cut_num = 0;
+			for (auto& net : _ins.get_netlist()) {
+				for (int b : net.block_list) {
+					if (part_of[b] != part_of[net.block_list.front()]) { ++cut_num; break; }
+				}
+			}
+			return cut_num;
+		}
+
+	private:
+		/// 把blocks划分为part_num份，要求part_num不超过块数，使每份至少一个块
+		int build(const vector<int>& blocks, int part_num) {
+			int index = _nodes.size();
+			_nodes.emplace_back();
+			for (int b : blocks) { _nodes[index].area += _ins.get_blocks().at(b).area; }
+			if (part_num == 1) {
+				_nodes[index].part = _parts.size();
+				_parts.push_back(blocks);
+				return index;
+			}
+			int left_num = part_num / 2;
+			vector<int> left, right;
+			bisect(blocks, 1.0 * left_num / part_num, { { left_num, part_num - left_num } }, left, right);
+			int left_index = build(left, left_num);
+			int right_index = build(right, part_num - left_num);
+			_nodes[index].left = left_index;
+			_nodes[index].right = right_index;
+			return index;
+		}
+
+		/// 一次二分：从随机种子沿线网广度优先生长出面积占比`ratio`的一侧，再用FM算法减少割线网；
+		/// 两侧分别至少保留min_nums[0]、min_nums[1]个块，以便继续划分
+		void bisect(const vector<int>& blocks, double ratio, const array<int, 2>& min_nums, vector<int>& left, vector<int>& right) {
+			int n = blocks.size();
+			for (int i = 0; i < n; ++i) { _local[blocks[i]] = i; }
+			// 限制在本子集内、至少连接两个块的线网
+			++_stamp;
+			vector<vector<int>> nets, vertex_nets(n);
+			for (int b : blocks) {
+				for (int nid : _ins.get_blocks().at(b).net_ids) {
+					if (_net_stamp[nid] == _stamp) { continue; }
+					_net_stamp[nid] = _stamp;
+					vector<int> pins;
+					for (int pb : _ins.get_netlist().at(nid).block_list) {
+						if (_local[pb] >= 0) { pins.push_back(_local[pb]); }
+					}
+					sort(pins.begin(), pins.end());
+					pins.erase(unique(pins.begin(), pins.end()), pins.end());
+					if (pins.size() < 2) { continue; }
+					for (int v : pins) { vertex_nets[v].push_back(nets.size()); }
+					nets.push_back(move(pins));
+				}
+			}
+			vector<long long> areas(n);
+			long long total_area = 0, max_area = 0;
+			for (int i = 0; i < n; ++i) {
+				areas[i] = _ins.get_blocks().at(blocks[i]).area;
+				total_area += areas[i];
+				max_area = max(max_area, areas[i]);
+			}
+			double target = ratio * total_area;
+			double tolerance = max(0.02 * total_area, 1.0 * max_area);
+
+			// 初始划分：广度优先生长，side=0为左侧
+			vector<int> side(n, 1);
+			vector<int> order(n);
+			iota(order.begin(), order.end(), 0);
+			shuffle(order.begin(), order.end(), _gen);
+			long long left_area = 0;
+			queue<int> frontier;
+			for (int k = 0; k < n && left_area < target; ++k) {
+				if (side[order[k]] == 0) { continue; }
+				frontier.push(order[k]);
+				side[order[k]] = 0;
+				left_area += areas[order[k]];
+				while (!frontier.empty() && left_area < target) {
+					int v = frontier.front(); frontier.pop();
+					for (int e : vertex_nets[v]) {
+						for (int u : nets[e]) {
+							if (side[u] == 0 || left_area >= target) { continue; }
+							side[u] = 0;
+							left_area += areas[u];
+							frontier.push(u);
+						}
+					}
+				}
+			}
+			// 补足两侧的块数：右侧不足时退回最后加入左侧的块，左侧不足时从右侧补
+			int left_num = count(side.begin(), side.end(), 0);
+			for (int k = n - 1; k >= 0 && n - left_num < min_nums[1]; --k) {
+				if (side[order[k]] == 1) { continue; }
+				side[order[k]] = 1;
+				left_area -= areas[order[k]];
+				--left_num;
+			}
+			for (int k = 0; k < n && left_num < min_nums[0]; ++k) {
+				if (side[order[k]] == 0) { continue; }
+				side[order[k]] = 0;
+				left_area += areas[order[k]];
+				++left_num;
+			}
+
+			for (int pass = 0; pass < 8; ++pass) {
+				if (fm_pass(nets, vertex_nets, areas, target, tolerance, min_nums, side, left_area) <= 0) { break; }
+			}
+
+			for (int i = 0; i < n; ++i) {
+				(side[i] == 0 ? left : right).push_back(blocks[i]);
+				_local[blocks[i]] = -1;
+			}
+		}
+
+		/// FM一轮：每个块至多移动一次，按增益(割线网减少数)从大到小移动且保持面积均衡和两侧块数下限，最后回退到累计增益最大处
+		int fm_pass(const vector<vector<int>>& nets, const vector<vector<int>>& vertex_nets, const vector<long long>& areas,
+			double target, double tolerance, const array<int, 2>& min_nums, vector<int>& side, long long& left_area) {
+			int n = side.size();
+			array<int, 2> side_nums{ { 0, 0 } };
+			for (int v = 0; v < n; ++v) { ++side_nums[side[v]]; }
+			vector<array<int, 2>> counts(nets.size(), array<int, 2>{ { 0, 0 } });
+			for (int e = 0; e < nets.size(); ++e) {
+				for (int v : nets[e]) { ++counts[e][side[v]]; }
+			}
+			auto gain = [&](int v) {
+				int g = 0;
+				for (int e : vertex_nets[v]) {
+					if (counts[e][side[v]] == 1) { ++g; }
+					if (counts[e][1 - side[v]] == 0) { --g; }
+				}
+				return g;
+			};
+			vector<int> versions(n, 0);
+			vector<bool> is_locked(n, false);
+			priority_queue<tuple<int, int, int>> heap; // (增益, 块, 版本)
+			for (int v = 0; v < n; ++v) { heap.emplace(gain(v), v, 0); }
+			vector<int> moves;
+			int total_gain = 0, best_gain = 0, best_move_num = 0;
+			while (!heap.empty() && moves.size() - best_move_num < 256) { // 长时间没有改进则提前结束本轮
+				int g, v, version;
+				tie(g, v, version) = heap.top(); heap.pop();
+				if (is_locked[v] || version != versions[v]) { continue; }
+				double new_left_area = left_area + (side[v] == 0 ? -areas[v] : areas[v]);
+				if (abs(new_left_area - target) > tolerance) { continue; } // 破坏均衡，本轮暂不移动
+				if (side_nums[side[v]] <= min_nums[side[v]]) { continue; } // 移走后该侧的块不够继续划分(会出现空分区)
+				--side_nums[side[v]];
+				++side_nums[1 - side[v]];
+				for (int e : vertex_nets[v]) {
+					--counts[e][side[v]];
+					++counts[e][1 - side[v]];
+				}
+				side[v] = 1 - side[v];
+				left_area = static_cast<long long>(new_left_area);
+				is_locked[v] = true;
+				moves.push_back(v);
+				total_gain += g;
+				if (total_gain > best_gain) {
+					best_gain = total_gain;
+					best_move_num = moves.size();
+				}
+				for (int e : vertex_nets[v]) {
+					for (int u : nets[e]) {
+						if (!is_locked[u]) { heap.emplace(gain(u), u, ++versions[u]); }
+					}
+				}
+			}
+			for (int k = moves.size() - 1; k >= best_move_num; --k) { // 回退
+				int v = moves[k];
+				side[v] = 1 - side[v];
+				left_area += side[v] == 0 ? areas[v] : -areas[v];
+			}
+			return best_gain;
+		}
+
+	private:
+		const Instance& _ins;
+		default_random_engine _gen;
+		vector<Node> _nodes;
+		vector<vector<int>> _parts;
+
+		vector<int> _local;     // 块在当前子集中的下标，不在子集中为-1
+		vector<int> _net_stamp; // 线网在当前子集中是否已处理
+		int _stamp;
+	};
+
+}
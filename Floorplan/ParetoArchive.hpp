@@ -0,0 +1,72 @@
+﻿//
+// @author   liyan
+// @contact  lyan_dut@outlook.com
+//
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "Data.hpp"
+
+namespace fbp {
+
+	using namespace std;
+
+	/// 非支配的(面积, 距离)解集，由所有packer共享；一次搜索即可读出任意α/β权重下的最优解
+	class ParetoArchive {
+	public:
+		struct Entry {
+			int area;
+			double dist; // 目标函数中的距离项
+			double wirelength;
+			int bin_width;
+			vector<Rect> dst;
+		};
+
+		/// 是否被已有解支配(或重复)；打包时先以此过滤，只为可能插入的解生成坐标
+		bool is_dominated(int area, double dist) const {
+			lock_guard<mutex> guard(_mutex);
+			auto pos = upper_area(area);
+			return pos != _entries.begin() && prev(pos)->dist <= dist;
+		}
+
+		/// 被已有解支配(或重复)时返回false；否则插入，并删除被它支配的解
+		bool insert(int area, double dist, double wirelength, int bin_width, const vector<Rect>& dst) {
+			lock_guard<mutex> guard(_mutex);
+			auto pos = upper_area(area);
+			if (pos != _entries.begin() && prev(pos)->dist <= dist) { return false; }
+			auto first = pos != _entries.begin() && prev(pos)->area == area ? prev(pos) : pos;
+			auto last = find_if(first, _entries.cend(), [dist](const Entry& e) { return e.dist < dist; });
+			first = _entries.erase(first, last);
+			_entries.insert(first, { area, dist, wirelength, bin_width, dst });
+			return true;
+		}
+
+		/// 权重(alpha, beta)下目标函数最小的解，解集为空时返回false
+		bool get_best(double alpha, double beta, Entry& best) const {
+			lock_guard<mutex> guard(_mutex);
+			auto iter = min_element(_entries.begin(), _entries.end(), [=](const Entry& lhs, const Entry& rhs) {
+				return alpha * lhs.area + beta * lhs.dist < alpha * rhs.area + beta * rhs.dist; });
+			if (iter == _entries.end()) { return false; }
+			best = *iter;
+			return true;
+		}
+
+		vector<Entry> get_entries() const {
+			lock_guard<mutex> guard(_mutex);
+			return _entries;
+		}
+
+	private:
+		/// _entries按面积升序、距离严格降序；面积不超过area的解中，距离最小的是返回位置之前的一个
+		vector<Entry>::const_iterator upper_area(int area) const {
+			return upper_bound(_entries.begin(), _entries.end(), area, [](int a, const Entry& e) { return a < e.area; });
+		}
+
+	private:
+		mutable mutex _mutex;
+		vector<Entry> _entries;
+	};
+}
@@ -12,6 +12,8 @@ namespace fbp {
 
 	class RandomLocalSearcher : public FloorplanPacker {
 
+		friend class MicroBenchmark;
+
 		/// 
 		struct SortRule {
 			vector<int> sequence;
@@ -22,63 +24,109 @@ namespace fbp {
 
 		RandomLocalSearcher() = delete;
 
-		RandomLocalSearcher(const Instance& ins, const vector<Rect>& src, int bin_width, default_random_engine& gen) :
-			FloorplanPacker(ins, src, bin_width, gen) {
+		RandomLocalSearcher(const Instance& ins, const vector<Rect>& src, int bin_width, unsigned int seed) :
+			FloorplanPacker(ins, src, bin_width, seed) {
 			reset();
 			init_sort_rules();
 		}
 
 		/// _bin_widthֲ
-		void run(int iter, double alpha, double beta, Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
-			// the first time to call RLS on W_k
-			if (iter == 1) {
-				for (auto& rule : _sort_rules) {
-					_rects.assign(rule.sequence.begin(), rule.sequence.end());
-					vector<Rect> target_dst;
-					vector<bool> is_packed(_src.size(), true);
-					int target_area = insert_bottom_left_score(target_dst) * _bin_width;
-					double target_dist;
-					double target_wirelength = cal_wirelength(target_dst, is_packed, target_dist, level_wl, level_dist);
-					rule.target_objective = cal_objective(target_area, target_dist, alpha, beta);
-					update_objective(rule.target_objective, target_area, target_wirelength, target_dst);
+		bool run(int iter, double alpha, double beta, Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			if (!_is_pending) {
+				// the first time to call RLS on W_k
+				if (iter == 1) {
+					for (auto& rule : _sort_rules) { evaluate_sort_rule(rule, alpha, beta, level_wl, level_dist); }
+					// УԽĿ꺯ֵԽСѡиԽ
+					sort(_sort_rules.begin(), _sort_rules.end(), [](auto& lhs, auto& rhs) {
+						return lhs.target_objective > rhs.target_objective; });
 				}
-				// УԽĿ꺯ֵԽСѡиԽ
-				sort(_sort_rules.begin(), _sort_rules.end(), [](auto& lhs, auto& rhs) {
-					return lhs.target_objective > rhs.target_objective; });
+				_run_iter = iter;
+				_next_iter = 1;
+				_picked_index = _discrete_dist(_gen);
+				_is_resort_needed = false;
 			}
 
 			// Ż
-			SortRule& picked_rule = _sort_rules[_discrete_dist(_gen)];
-			bool is_resort_needed = false;
-			for (int i = 1; i <= iter; ++i) {
+			SortRule& picked_rule = _sort_rules[_picked_index];
+			for (; _next_iter <= _run_iter; ++_next_iter) {
+				if (!next_step()) { _is_pending = true; return false; }
 				SortRule new_rule = picked_rule;
-				if (iter % 4) { swap_sort_rule(new_rule); }
+				if (_run_iter % 4) { swap_sort_rule(new_rule); }
 				else { rotate_sort_rule(new_rule); }
-				_rects.assign(new_rule.sequence.begin(), new_rule.sequence.end());
-				vector<Rect> target_dst;
-				vector<bool> is_packed(_src.size(), true);
-				int target_area = insert_bottom_left_score(target_dst) * _bin_width;
-				double target_dist;
-				double target_wirelength = cal_wirelength(target_dst, is_packed, target_dist, level_wl, level_dist);
-				new_rule.target_objective = cal_objective(target_area, target_dist, alpha, beta);
+				evaluate_sort_rule(new_rule, alpha, beta, level_wl, level_dist);
 				if (new_rule.target_objective <= picked_rule.target_objective) {
 					picked_rule = new_rule;
-					is_resort_needed = true;
-					update_objective(picked_rule.target_objective, target_area, target_wirelength, target_dst);
+					_is_resort_needed = true;
 				}
 			}
+			_is_pending = false;
 			// б
-			if (is_resort_needed) {
+			if (_is_resort_needed) {
 				sort(_sort_rules.begin(), _sort_rules.end(), [](auto& lhs, auto& rhs) {
 					return lhs.target_objective > rhs.target_objective; });
 			}
+			return true;
+		}
+
+		void set_fixed(const vector<Rect>& dst, const vector<bool>& is_fixed) {
+			FloorplanPacker::set_fixed(dst, is_fixed);
+			_sort_rules.clear();
+			init_sort_rules(); // ֻĿ
+		}
+
+		/// ӢУǰĿ꺯ֵС
+		const vector<int>& get_elite_sequence() const { return _sort_rules.back().sequence; }
+
+		/// ǨУڵǰ_bin_width滻
+		bool accept_sequence(const vector<int>& sequence, double alpha, double beta,
+			Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			if (_is_pending) { return false; }
+			SortRule new_rule{ sequence, numeric_limits<double>::max() };
+			evaluate_sort_rule(new_rule, alpha, beta, level_wl, level_dist);
+			if (new_rule.target_objective >= _sort_rules.front().target_objective) { return false; }
+			_sort_rules.front() = move(new_rule);
+			sort(_sort_rules.begin(), _sort_rules.end(), [](auto& lhs, auto& rhs) {
+				return lhs.target_objective > rhs.target_objective; });
+			return true;
+		}
+
+		void save(ostream& os) const {
+			FloorplanPacker::save(os);
+			os << _sort_rules.size();
+			for (auto& rule : _sort_rules) {
+				os << ' ' << rule.target_objective;
+				for (int i : rule.sequence) { os << ' ' << i; }
+			}
+			os << '\n';
+		}
+
+		bool load(istream& is) {
+			if (!FloorplanPacker::load(is)) { return false; }
+			size_t rule_num = 0;
+			is >> rule_num;
+			if (!is || rule_num != _sort_rules.size()) { return false; }
+			for (auto& rule : _sort_rules) {
+				is >> rule.target_objective;
+				for (int& i : rule.sequence) { is >> i; }
+			}
+			return static_cast<bool>(is);
+		}
+
+		void account_memory(utils::MemoryUsage& usage) const {
+			FloorplanPacker::account_memory(usage);
+			long long sort_rules = utils::heap_bytes(_sort_rules);
+			for (auto& rule : _sort_rules) { sort_rules += utils::heap_bytes(rule.sequence); }
+			usage.resident["rls.sort_rules"] += sort_rules;
+			usage.resident["rls.workspace"] += utils::heap_bytes(_skyline) + utils::heap_bytes(_rects)
+				+ utils::heap_bytes(_target_placement.x) + utils::heap_bytes(_target_placement.y) + utils::heap_bytes(_target_placement.flags);
 		}
 
 		/// ʹֲԣ̰Ĺһ
-		int insert_bottom_left_score(vector<Rect>& dst) {
-			int skyline_height = 0;
+		int insert_bottom_left_score(Placement& placement) {
+			profile_scope(RlsPacking);
 			reset();
-			dst = _src;
+			int skyline_height = max_element(_skyline.begin(), _skyline.end(), [](auto& lhs, auto& rhs) { return lhs.y < rhs.y; })->y;
+			placement = _base_placement;
 
 			while (!_rects.empty()) {
 				auto bottom_skyline_iter = min_element(_skyline.begin(), _skyline.end(), [](auto& lhs, auto& rhs) {
@@ -95,14 +143,16 @@ namespace fbp {
 					continue;
 				}
 
-				int best_rect_index = find_rect_for_skyline_bottom_left(best_skyline_index, dst);
+				int rect_width, rect_height, rect_xcoord;
+				int best_rect_index = find_rect_for_skyline_bottom_left(best_skyline_index, rect_width, rect_height, rect_xcoord);
 				assert(best_rect_index != -1);
+				placement.place(best_rect_index, rect_xcoord, _skyline[best_skyline_index].y, rect_width != _widths[best_rect_index]);
 
 				// δбɾ
 				_rects.remove(best_rect_index);
 
 				// skyline
-				SkylineNode new_skyline_node = { dst[best_rect_index].x, dst[best_rect_index].y + dst[best_rect_index].height, dst[best_rect_index].width };
+				SkylineNode new_skyline_node = { rect_xcoord, _skyline[best_skyline_index].y + rect_height, rect_width };
 				if (new_skyline_node.x == _skyline[best_skyline_index].x) { // 
 					_skyline.insert(_skyline.begin() + best_skyline_index, new_skyline_node);
 					_skyline[best_skyline_index + 1].x += new_skyline_node.width;
@@ -115,6 +165,7 @@ namespace fbp {
 					merge_skylines(_skyline);
 				}
 				skyline_height = max(skyline_height, new_skyline_node.y);
+				if (skyline_height > _bin_height) { break; } // ߶Ͻ磬֦
 			}
 
 			return skyline_height;
@@ -123,15 +174,13 @@ namespace fbp {
 	private:
 		/// ÿε_skyLine
 		void reset() {
-			_skyline.clear();
-			_skyline.push_back({ 0,0,_bin_width });
+			_skyline = _base_skyline;
 		}
 
 		/// ʼб
 		void init_sort_rules() {
-			vector<int> seq(_src.size());
 			// 0_˳
-			iota(seq.begin(), seq.end(), 0);
+			const vector<int>& seq = _free_rects;
 			_sort_rules.reserve(5);
 			for (int i = 0; i < 5; ++i) { _sort_rules.push_back({ seq, numeric_limits<double>::max() }); }
 			// 1_ݼ
@@ -154,11 +203,30 @@ namespace fbp {
 			for (int i = 1; i <= _sort_rules.size(); ++i) { probs.push_back(2 * i); }
 			_discrete_dist = discrete_distribution<>(probs.begin(), probs.end());
 			// ȷֲʼ
-			_uniform_dist = uniform_int_distribution<>(0, _src.size() - 1);
+			_uniform_dist = uniform_int_distribution<>(0, seq.size() - 1);
+		}
+
+		/// ͬʱŽ
+		void evaluate_sort_rule(SortRule& rule, double alpha, double beta, Config::LevelWireLength level_wl, Config::LevelObjDist level_dist) {
+			_rects.assign(rule.sequence.begin(), rule.sequence.end());
+			int target_height = insert_bottom_left_score(_target_placement);
+			++_pack_num;
+			if (target_height > _bin_height) { // У
+				++_prune_num;
+				rule.target_objective = numeric_limits<double>::max();
+				return;
+			}
+			int target_area = target_height * _bin_width;
+			double target_dist;
+			double target_wirelength = cal_wirelength(_target_placement, target_dist, level_wl, level_dist);
+			rule.target_objective = cal_objective(target_area, target_dist, alpha, beta);
+			archive(target_area, target_dist, target_wirelength, _target_placement);
+			update_objective(rule.target_objective, target_area, target_wirelength, _target_placement);
 		}
 
 		/// 1˳
 		void swap_sort_rule(SortRule& rule) {
+			if (rule.sequence.size() < 2) { return; }
 			int a = _uniform_dist(_gen);
 			int b = _uniform_dist(_gen);
 			while (a == b) { b = _uniform_dist(_gen); }
@@ -171,103 +239,9 @@ namespace fbp {
 			rotate(rule.sequence.begin(), rule.sequence.begin() + a, rule.sequence.end());
 		}
 
-		/// ڴֲΪ½ѡһ
-		int find_rect_for_skyline_bottom_left(int skyline_index, vector<Rect>& dst) {
-			int best_rect = -1, best_score = -1;
-			for (int r : _rects) {
-				int width = _src.at(r).width, height = _src.at(r).height;
-				int x, score;
-				for (int rotate = 0; rotate <= 1; ++rotate) {
-					if (rotate) { swap(width, height); }
-					if (score_rect_for_skyline_bottom_left(skyline_index, width, height, x, score)) {
-						if (best_score < score) {
-							best_score = score;
-							best_rect = r;
-							dst[r].x = x;
-							dst[r].y = _skyline[skyline_index].y;
-							dst[r].width = width;
-							dst[r].height = height;
-						}
-					}
-				}
-			}
-			// (d)(f)(h)˻
-			if ((best_score == 4 || best_score == 2 || best_score == 0) && _rects.size() > 1) {
-				int min_unpacked_width = numeric_limits<int>::max();
-				for (int r : _rects) {
-					if (r == best_rect) { continue; }
-					min_unpacked_width = min(min_unpacked_width, _src.at(r).width);
-				}
-				// δõСȷŲ£˷
-				if (min_unpacked_width > _skyline[skyline_index].width - dst[best_rect].width) {
-					SkylineSpace space = skyline_nodo_to_space(_skyline, skyline_index);
-					int min_space_height = min(space.hl, space.hr);
-					int new_best_rect = -1;
-					int new_best_width = 0, new_best_height;
-					for (int r : _rects) {
-						for (int rotate = 0; rotate <= 1; ++rotate) {
-							int width = _src.at(r).width, height = _src.at(r).height;
-							if (rotate) { swap(width, height); }
-							if (height >= min_space_height // ߲Сmin_space_height
-								&& width <= space.width // ܷ
-								&& width > new_best_width) { // 
-								new_best_rect = r;
-								new_best_width = width;
-								new_best_height = height;
-							}
-						}
-					}
-					if (new_best_rect != -1) {
-						best_rect = new_best_rect;
-						dst[best_rect].width = new_best_width;
-						dst[best_rect].height = new_best_height;
-						dst[best_rect].y = _skyline[skyline_index].y;
-						dst[best_rect].x = space.hl >= space.hr ? // 뿿ߵһ
-							_skyline[skyline_index].x : // 
-							_skyline[skyline_index].x + _skyline[skyline_index].width - new_best_width; // 
-					}
-				}
-			}
-
-			return best_rect;
-		}
-
-		/// ֲ
-		bool score_rect_for_skyline_bottom_left(int skyline_index, int width, int height, int& x, int& score) {
-			if (width > _skyline[skyline_index].width) { return false; }
-
-			SkylineSpace space = skyline_nodo_to_space(_skyline, skyline_index);
-			if (space.hl >= space.hr) {
-				if (width == space.width && height == space.hl) { score = 7; }
-				else if (width == space.width && height == space.hr) { score = 6; }
-				else if (width == space.width && height > space.hl) { score = 5; }
-				else if (width < space.width && height == space.hl) { score = 4; }
-				else if (width == space.width && height < space.hl && height > space.hr) { score = 3; }
-				else if (width < space.width && height == space.hr) { score = 2; } // 
-				else if (width == space.width && height < space.hr) { score = 1; }
-				else if (width < space.width && height != space.hl) { score = 0; }
-				else { return false; }
-
-				if (score == 2) { x = _skyline[skyline_index].x + _skyline[skyline_index].width - width; }
-				else { x = _skyline[skyline_index].x; }
-			}
-			else { // hl < hr
-				if (width == space.width && height == space.hr) { score = 7; }
-				else if (width == space.width && height == space.hl) { score = 6; }
-				else if (width == space.width && height > space.hr) { score = 5; }
-				else if (width < space.width && height == space.hr) { score = 4; } // 
-				else if (width == space.width && height < space.hr && height > space.hl) { score = 3; }
-				else if (width < space.width && height == space.hl) { score = 2; }
-				else if (width == space.width && height < space.hl) { score = 1; }
-				else if (width < space.width && height != space.hr) { score = 0; } // 
-				else { return false; }
-
-				if (score == 4 || score == 0) { x = _skyline[skyline_index].x + _skyline[skyline_index].width - width; }
-				else { x = _skyline[skyline_index].x; }
-			}
-			if (x + width > _bin_width) { return false; }
-
-			return true;
+		/// ڴֲΪ½ѡһ飬ؿżúĿߺx
+		int find_rect_for_skyline_bottom_left(int skyline_index, int& rect_width, int& rect_height, int& rect_xcoord) {
+			return find_rect_for_space(skyline_nodo_to_space(_skyline, skyline_index), _rects, rect_width, rect_height, rect_xcoord);
 		}
 
 	private:
@@ -276,8 +250,15 @@ namespace fbp {
 		// бֲ  
 		vector<SortRule> _sort_rules;
 		list<int> _rects; // SortRulesequence൱ָ룬ʹlistɾΪ
+		Placement _target_placement; // ʱĴ
 		discrete_distribution<> _discrete_dist;   // ɢʷֲѡ(ѡsequence_rects)
 		uniform_int_distribution<> _uniform_dist; // ȷֲڽ˳
+
+		// ϵ״̬ռӵ_next_iterε
+		int _run_iter;
+		int _next_iter;
+		int _picked_index;
+		bool _is_resort_needed;
 	};
 
 }
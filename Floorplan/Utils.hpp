@@ -4,9 +4,38 @@
 //
 #pragma once
 
+#include <algorithm>
 #include <ctime>
+#include <cstdio>
+#include <array>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <queue>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
 #include <sstream>
 #include <iomanip>
+#include <list>
+#include <map>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
 
 
 namespace utils {
@@ -19,7 +48,7 @@ namespace utils {
 		ChebyshevDist  // бѩ
 	};
 
-	static double cal_distance(LevelDist method, double x1, double y1, double x2, double y2) {
+	inline double cal_distance(LevelDist method, double x1, double y1, double x2, double y2) {
 		double distance = 0;
 		switch (method) {
 		case LevelDist::EuclideanDist:
@@ -35,7 +64,7 @@ namespace utils {
 	}
 
 	// ļеn 
-	static void skip(FILE* file, int line_num) {
+	inline void skip(FILE* file, int line_num) {
 		char linebuf[1000];
 		for (int i = 0; i < line_num; ++i)
 			fgets(linebuf, sizeof(linebuf), file); // skip
@@ -44,80 +73,488 @@ namespace utils {
 	class Date {
 	public:
 		// رʾڸʽַ
-		static const string to_short_str() {
-			ostringstream os;
-			time_t now = time(0);
-			os << put_time(localtime(&now), "%y%m%d");
-			return os.str();
-		}
+		static const string to_short_str() { return format_now("%y%m%d"); }
 		// رʾڸʽַʱ
-		static const string to_long_str() {
+		static const string to_long_str() { return format_now("%y%m%d%H%M%S"); }
+
+	private:
+		// `localtime`عľ̵̬߳
+		static string format_now(const char* fmt) {
+			static mutex localtime_mutex;
+			lock_guard<mutex> guard(localtime_mutex);
 			ostringstream os;
 			time_t now = time(0);
-			os << put_time(localtime(&now), "%y%m%d%H%M%S");
+			os << put_time(localtime(&now), fmt);
 			return os.str();
 		}
 	};
 
-	class Combination {
+	// ļ·ȡͬһڶ߳дͬһļʱȼ
+	inline mutex& path_mutex(const string& path) {
+		static mutex registry_mutex;
+		static unordered_map<string, unique_ptr<mutex>> registry;
+		lock_guard<mutex> guard(registry_mutex);
+		unique_ptr<mutex>& path_mtx = registry[path];
+		if (!path_mtx) { path_mtx.reset(new mutex); }
+		return *path_mtx;
+	}
+
+	// ̶С̳߳أύ˳ִУʱȴеȫ
+	class ThreadPool {
 	public:
-		Combination(const vector<int>& a, int k) : _a(a), _n(a.size()), _k(k), _index(a.size(), false), _first_comb(true) {}
-
-		bool next_combination(vector<int>& comb, vector<int>& ncomb) {
-			if (_first_comb) { // һϣѡǰkλ
-				_first_comb = false;
-				for (int i = 0; i < _k; ++i) { _index[i] = true; }
-				record_combination(comb, ncomb);
-				return true;
-			}
-
-			if (!has_done()) {
-				for (int i = 0; i < _n - 1; ++i) {
-					// ҵһ10Ͻ"01"
-					if (_index[i] && !_index[i + 1]) {
-						_index[i] = false;
-						_index[i + 1] = true;
-						// "01"ߵ1Ƶ
-						int count = 0;
-						for (int j = 0; j < i; ++j) {
-							if (_index[j]) {
-								_index[j] = false;
-								_index[count++] = true;
-							}
-						}
-						record_combination(comb, ncomb);
-						return true;
-					}
+		ThreadPool(int thread_num) : _is_stopped(false) {
+			_workers.reserve(thread_num);
+			for (int i = 0; i < thread_num; ++i) { _workers.emplace_back([this] { work(); }); }
+		}
+
+		~ThreadPool() {
+			{
+				lock_guard<mutex> guard(_mutex);
+				_is_stopped = true;
+			}
+			_cv.notify_all();
+			for (auto& worker : _workers) { worker.join(); }
+		}
+
+		void submit(function<void()> task) {
+			{
+				lock_guard<mutex> guard(_mutex);
+				_tasks.push(move(task));
+			}
+			_cv.notify_one();
+		}
+
+		int size() const { return _workers.size(); }
+
+	private:
+		void work() {
+			while (true) {
+				function<void()> task;
+				{
+					unique_lock<mutex> lock(_mutex);
+					_cv.wait(lock, [this] { return _is_stopped || !_tasks.empty(); });
+					if (_tasks.empty()) { return; }
+					task = move(_tasks.front());
+					_tasks.pop();
 				}
+				task();
 			}
+		}
+
+	private:
+		vector<thread> _workers;
+		queue<function<void()>> _tasks;
+		mutex _mutex;
+		condition_variable _cv;
+		bool _is_stopped;
+	};
+
+	// λӼͶ̬滮λi1ʾiɴ
+	class Bitset {
+	public:
+		Bitset(int size) : _size(size), _words((size + 63) / 64, 0) {}
+
+		int size() const { return _size; }
+
+		void set(int i) { _words[i >> 6] |= uint64_t(1) << (i & 63); }
 
-			return false;
+		bool test(int i) const { return (_words[i >> 6] >> (i & 63)) & 1; }
+
+		// *this |= src << shiftsizeλ
+		void or_shifted(const Bitset& src, int shift) {
+			int word_shift = shift >> 6, bit_shift = shift & 63;
+			for (int i = static_cast<int>(_words.size()) - 1; i >= word_shift; --i) {
+				uint64_t word = src._words[i - word_shift] << bit_shift;
+				if (bit_shift && i - word_shift > 0) { word |= src._words[i - word_shift - 1] >> (64 - bit_shift); }
+				_words[i] |= word;
+			}
+			if (_size & 63) { _words.back() &= (uint64_t(1) << (_size & 63)) - 1; }
 		}
 
 	private:
-		bool has_done() const { // ֹkλȫ1
-			for (int i = _n - 1; i >= _n - _k; --i)
-				if (!_index[i])
-					return false;
-			return true;
+		int _size;
+		vector<uint64_t> _words;
+	};
+
+	// SplitMix64ӣͬһӵĲͬŵõصӣ˳޹
+	inline unsigned int split_seed(unsigned long long seed, unsigned long long stream) {
+		uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (stream + 1);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return static_cast<unsigned int>((z ^ (z >> 31)) >> 32);
+	}
+
+	// steady_clockĽֹʱ䣬ȡǣɿ̵߳cancel()
+	class Deadline {
+	public:
+		using Clock = chrono::steady_clock;
+
+		Deadline(double seconds) : _start(Clock::now()), _cancelled(false), _parent(nullptr) { reset(seconds); }
+
+		// ӵǰʱ¼ʱ`elapsed`Ϊǰõʱ(Ӽָʱ)
+		void reset(double seconds, double elapsed = 0) {
+			_start = Clock::now() - chrono::duration_cast<Clock::duration>(chrono::duration<double>(elapsed));
+			_end = _start + chrono::duration_cast<Clock::duration>(chrono::duration<double>(seconds));
+			_cancelled.store(false, memory_order_relaxed);
 		}
 
-		void record_combination(vector<int>& comb, vector<int>& ncomb) const {
-			comb.clear(); comb.reserve(_k);
-			ncomb.clear(); ncomb.reserve(_n - _k);
-			for (int i = 0; i < _n; ++i) {
-				if (_index[i])
-					comb.push_back(_a[i]);
-				else
-					ncomb.push_back(_a[i]);
+		void cancel() { _cancelled.store(true, memory_order_relaxed); }
+
+		// Ľֹʱ䣺ϼʱȡʱһ
+		void set_parent(const Deadline* parent) { _parent = parent; }
+
+		bool expired() const {
+			return _cancelled.load(memory_order_relaxed) || Clock::now() >= _end || (_parent && _parent->expired());
+		}
+
+		// ʣʱ()С0
+		double remaining() const { return max(0.0, chrono::duration<double>(_end - Clock::now()).count()); }
+
+		// ʱ()
+		double elapsed() const { return chrono::duration<double>(Clock::now() - _start).count(); }
+
+	private:
+		Clock::time_point _start;
+		Clock::time_point _end;
+		atomic<bool> _cancelled;
+		const Deadline* _parent;
+	};
+
+	// ѭĽ׶μʱʱFBP_PROFILEŲʱ(profile_scopeprofile_count)
+	// һ(Session)߳̾AttachۼӵԼĻ壬޾뿪ʱô⡣
+	// ׶Ϊʱ䣬Ƕ׵Ľ׶ظ룻ηõںֻƴʱĿᳬʱİٷ֮
+	class Profiler {
+	public:
+		enum Phase { Branch, LocalEvaluation, GlobalEvaluation, GreedyConstruction, InsertChosenRect, CalWirelength, RlsPacking, PhaseNum };
+
+		struct Counter {
+			long long calls = 0;
+			long long nanoseconds = 0;
+		};
+
+		using Counters = array<Counter, PhaseNum>;
+
+#ifdef FBP_PROFILE
+		static constexpr bool enabled = true;
+#else
+		static constexpr bool enabled = false;
+#endif // FBP_PROFILE
+
+		static const char* phase_name(int phase) {
+			static const char* names[PhaseNum] = { "branch", "local_evaluation", "global_evaluation", "greedy_construction",
+				"insert_chosen_rect_for_parent", "cal_wirelength", "rls_packing" };
+			return names[phase];
+		}
+
+		// һļɶ̲߳
+		class Session {
+		public:
+			void merge(const Counters& counters) {
+				lock_guard<mutex> guard(_mutex);
+				for (int p = 0; p < PhaseNum; ++p) {
+					_counters[p].calls += counters[p].calls;
+					_counters[p].nanoseconds += counters[p].nanoseconds;
+				}
 			}
+
+			Counters total() const {
+				lock_guard<mutex> guard(_mutex);
+				return _counters;
+			}
+
+		private:
+			mutable mutex _mutex;
+			Counters _counters;
+		};
+
+		// ǰ߳ڵļʱsessionǶףڲ()ڼͣ
+		class Attach {
+		public:
+			Attach(Session& session) : _session(session), _outer(current()) { current() = &_counters; }
+
+			~Attach() {
+				current() = _outer;
+				_session.merge(_counters);
+			}
+
+		private:
+			Session& _session;
+			Counters* _outer;
+			Counters _counters;
+		};
+
+		class Scope {
+		public:
+			Scope(Phase phase) : _counter(current() ? &(*current())[phase] : nullptr) {
+				if (_counter) { _start = chrono::steady_clock::now(); }
+			}
+
+			~Scope() {
+				if (!_counter) { return; }
+				++_counter->calls;
+				_counter->nanoseconds += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - _start).count();
+			}
+
+		private:
+			Counter* _counter;
+			chrono::steady_clock::time_point _start;
+		};
+
+		static void count(Phase phase) {
+			if (current()) { ++(*current())[phase].calls; }
 		}
 
 	private:
-		const vector<int>& _a;
-		const int _n;
-		const int _k;
-		vector<bool> _index;
-		bool _first_comb;
+		static Counters*& current() {
+			static thread_local Counters* counters = nullptr;
+			return counters;
+		}
 	};
+
+#ifdef FBP_PROFILE
+#define profile_scope(phase) utils::Profiler::Scope profile_scope_guard(utils::Profiler::phase)
+#define profile_count(phase) utils::Profiler::count(utils::Profiler::phase)
+#else
+#define profile_scope(phase)
+#define profile_count(phase)
+#endif // FBP_PROFILE
+
+	// ڶռõֽ㣬Ķ⿪
+	template<typename T>
+	inline long long heap_bytes(const vector<T>& v) { return 1LL * v.capacity() * sizeof(T); }
+
+	inline long long heap_bytes(const vector<bool>& v) { return (v.capacity() + 7) / 8; }
+
+	template<typename T>
+	inline long long heap_bytes(const list<T>& l) { return 1LL * l.size() * (sizeof(T) + 2 * sizeof(void*)); }
+
+	inline long long heap_bytes(const string& s) { return s.capacity() > 15 ? s.capacity() + 1 : 0; } // ַڶڲ
+
+	// ڴռõķͳ(ֽ)
+	// residentΪͬʱפĲ֣ϲʱӣtransientΪγֵʱֵ(ĵ)ϲʱȡ
+	struct MemoryUsage {
+		map<string, long long> resident;
+		map<string, long long> transient;
+
+		void merge(const MemoryUsage& other) {
+			for (auto& item : other.resident) { resident[item.first] += item.second; }
+			for (auto& item : other.transient) { transient[item.first] = max(transient[item.first], item.second); }
+		}
+
+		// transientǰ׺
+		void merge_transient(const MemoryUsage& other, const string& prefix) {
+			for (auto& items : { &other.resident, &other.transient }) {
+				for (auto& item : *items) { transient[prefix + item.first] = max(transient[prefix + item.first], item.second); }
+			}
+		}
+
+		long long total() const {
+			long long bytes = 0;
+			for (auto& item : resident) { bytes += item.second; }
+			for (auto& item : transient) { bytes += item.second; }
+			return bytes;
+		}
+	};
+
+	// ̵ķֵפڴ(ֽ)ȡʧܷ0
+	inline long long peak_rss_bytes() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+		return counters.PeakWorkingSetSize;
+#else
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#ifdef __APPLE__
+		return usage.ru_maxrss; // macOSֽΪλ
+#else
+		return usage.ru_maxrss * 1024LL; // LinuxKBΪλ
+#endif
+#endif
+	}
+
+	// 䣺ͶݸδȡߵľϢȡźգдȫ
+	template<typename T>
+	class Mailbox {
+	public:
+		Mailbox() : _slot(nullptr) {}
+		Mailbox(const Mailbox&) = delete;
+		Mailbox& operator=(const Mailbox&) = delete;
+		~Mailbox() { delete _slot.load(); }
+
+		void post(unique_ptr<T> msg) { delete _slot.exchange(msg.release(), memory_order_acq_rel); }
+
+		unique_ptr<T> fetch() { return unique_ptr<T>(_slot.exchange(nullptr, memory_order_acq_rel)); }
+
+	private:
+		atomic<T*> _slot;
+	};
+
+	// ̨дļֻһݴдݣдʱļ̱ɱʱдһļ
+	class AsyncFileWriter {
+	public:
+		AsyncFileWriter(const string& path) : _path(path), _has_pending(false), _is_stopped(false), _worker(&AsyncFileWriter::work, this) {}
+		AsyncFileWriter(const AsyncFileWriter&) = delete;
+		AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+		// дһݴдݺ˳
+		~AsyncFileWriter() {
+			{
+				lock_guard<mutex> guard(_mutex);
+				_is_stopped = true;
+			}
+			_cv.notify_one();
+			_worker.join();
+		}
+
+		void post(string content) {
+			{
+				lock_guard<mutex> guard(_mutex);
+				_pending = move(content);
+				_has_pending = true;
+			}
+			_cv.notify_one();
+		}
+
+	private:
+		void work() {
+			unique_lock<mutex> lock(_mutex);
+			while (true) {
+				_cv.wait(lock, [this] { return _has_pending || _is_stopped; });
+				if (!_has_pending) { return; }
+				string content = move(_pending);
+				_has_pending = false;
+				lock.unlock();
+				write(content);
+				lock.lock();
+			}
+		}
+
+		void write(const string& content) const {
+			string tmp_path = _path + ".tmp";
+			FILE* file = fopen(tmp_path.c_str(), "wb");
+			if (!file) {
+				fprintf(stderr, "%s: cannot open for writing\n", tmp_path.c_str());
+				return;
+			}
+			bool is_written = fwrite(content.data(), 1, content.size(), file) == content.size();
+			is_written = fflush(file) == 0 && is_written;
+			fclose(file);
+			if (!is_written) {
+				fprintf(stderr, "%s: write failed\n", tmp_path.c_str());
+				return;
+			}
+			if (rename(tmp_path.c_str(), _path.c_str()) != 0) { // WindowsĿļʱrenameʧ
+				remove(_path.c_str());
+				rename(tmp_path.c_str(), _path.c_str());
+			}
+		}
+
+	private:
+		const string _path;
+		mutex _mutex;
+		condition_variable _cv;
+		string _pending;
+		bool _has_pending;
+		bool _is_stopped;
+		thread _worker; // ʼʱԱѾ
+	};
+
+	// ׷дļḷ̨́߳÷ֻƴַдˢں̨߳
+	// is_continuedΪtrueʱļĩβ(Ӽָ)д
+	class AsyncAppendWriter {
+	public:
+		AsyncAppendWriter(const string& path, bool is_continued = false) : _path(path), _file(fopen(path.c_str(), is_continued ? "ab" : "wb")), _is_stopped(false), _worker(&AsyncAppendWriter::work, this) {
+			if (!_file) { fprintf(stderr, "%s: cannot open for writing\n", _path.c_str()); }
+		}
+		AsyncAppendWriter(const AsyncAppendWriter&) = delete;
+		AsyncAppendWriter& operator=(const AsyncAppendWriter&) = delete;
+
+		// дȫдݺ˳
+		~AsyncAppendWriter() {
+			{
+				lock_guard<mutex> guard(_mutex);
+				_is_stopped = true;
+			}
+			_cv.notify_one();
+			_worker.join();
+			if (_file) { fclose(_file); }
+		}
+
+		void append(const string& content) {
+			{
+				lock_guard<mutex> guard(_mutex);
+				_pending += content;
+			}
+			_cv.notify_one();
+		}
+
+	private:
+		void work() {
+			unique_lock<mutex> lock(_mutex);
+			while (true) {
+				_cv.wait(lock, [this] { return !_pending.empty() || _is_stopped; });
+				if (_pending.empty()) { return; }
+				string content;
+				content.swap(_pending);
+				lock.unlock();
+				if (_file && (fwrite(content.data(), 1, content.size(), _file) != content.size() || fflush(_file) != 0)) {
+					fprintf(stderr, "%s: write failed\n", _path.c_str());
+				}
+				lock.lock();
+			}
+		}
+
+	private:
+		const string _path;
+		FILE* _file;
+		mutex _mutex;
+		condition_variable _cv;
+		string _pending;
+		bool _is_stopped;
+		thread _worker; // ʼʱԱѾ
+	};
+
+	// ˳ϣ˳̲߳ٲͬȽ߳ʹ߳
+	class Barrier {
+	public:
+		Barrier(int count) : _count(count), _waiting(0), _phase(0) {}
+
+		void arrive_and_wait() {
+			unique_lock<mutex> lock(_mutex);
+			long long phase = _phase;
+			if (++_waiting >= _count) { next_phase(); }
+			else { _cv.wait(lock, [&] { return phase != _phase; }); }
+		}
+
+		void arrive_and_drop() {
+			lock_guard<mutex> guard(_mutex);
+			--_count;
+			if (_waiting > 0 && _waiting >= _count) { next_phase(); }
+		}
+
+	private:
+		void next_phase() {
+			_waiting = 0;
+			++_phase;
+			_cv.notify_all();
+		}
+
+	private:
+		mutex _mutex;
+		condition_variable _cv;
+		int _count;
+		int _waiting;
+		long long _phase;
+	};
+
+	// ̰߳ȡ[0, n)еȫɺ󷵻
+	inline void parallel_for(int n, const function<void(int)>& task, int thread_num = max(1u, thread::hardware_concurrency())) {
+		atomic<int> next(0);
+		auto work = [&] { for (int i; (i = next++) < n;) { task(i); } };
+		vector<thread> workers;
+		for (int t = 1; t < min(thread_num, n); ++t) { workers.emplace_back(work); }
+		work();
+		for (auto& worker : workers) { worker.join(); }
+	}
 }